@@ -0,0 +1,63 @@
+#version 330 core
+
+precision highp float;
+
+
+in vec2 f_st;
+
+// (escape count, smooth escape count) per pixel, from the iterate pass; may
+// be a different size than the target, it is sampled nearest
+uniform sampler2D iterations;
+
+// interpolate the palette with the smooth count instead of banding
+uniform bool smooth_coloring = false;
+
+
+const vec3 palette[16] = vec3[16](
+    vec3( 66,  30,  15), // brown 3
+    vec3( 25,   7,  26), // dark violett
+    vec3(  9,   1,  47), // darkest blue
+    vec3(  4,   4,  73), // blue 5
+    vec3(  0,   7, 100), // blue 4
+    vec3( 12,  44, 138), // blue 3
+    vec3( 24,  82, 177), // blue 2
+    vec3( 57, 125, 209), // blue 1
+    vec3(134, 181, 229), // blue 0
+    vec3(211, 236, 248), // lightest blue
+    vec3(241, 233, 191), // lightest yellow
+    vec3(248, 201,  95), // light yellow
+    vec3(255, 170,   0), // dirty yellow
+    vec3(204, 128,   0), // brown 0
+    vec3(153,  87,   0), // brown 1
+    vec3(106,  52,   3)  // brown 2
+);
+
+
+vec4 color_for_depth(uint i)
+{
+    const uint N = uint(palette.length());
+    i = i % N;
+    return vec4(palette[i] / 255.0, 1.0);
+}
+
+vec4 color_for_smooth_depth(float mu)
+{
+    const uint N = uint(palette.length());
+    uint i = uint(floor(mu));
+    vec3 a = palette[i % N];
+    vec3 b = palette[(i + 1u) % N];
+    return vec4(mix(a, b, fract(mu)) / 255.0, 1.0);
+}
+
+
+void main()
+{
+    ivec2 size = textureSize(iterations, 0);
+    ivec2 texel = clamp(ivec2((f_st * 0.5 + 0.5) * vec2(size)), ivec2(0), size - 1);
+    vec2 it = texelFetch(iterations, texel, 0).xy;
+
+    if (smooth_coloring)
+        gl_FragColor = color_for_smooth_depth(it.y);
+    else
+        gl_FragColor = color_for_depth(uint(it.x));
+}
@@ -0,0 +1,56 @@
+#version 330 core
+
+precision highp float;
+
+
+in vec2 f_st;
+
+layout(location = 0) out vec4 f_color;
+
+// colored exponential map around the frame's center, kept by ZoomVideo as a
+// ring of rows: column x is the angle 2pi (x + 0.5) / width, and map row r
+// (counted from the outermost, at row r % height of the ring) is the radius
+// r0 e^(-(r + 0.5) * 2pi / width), so texels are square in log-polar space
+uniform sampler2D exp_map;
+
+// frame size in pixels
+uniform vec2 frame_size = vec2(1.0);
+
+// the map row under a point 1 pixel from the frame's center, split into an
+// integer and a fraction since deep maps have more rows than a float counts
+uniform int row_base = 0;
+uniform float row_frac = 0.0;
+
+
+// i mod n for i in [-2n, inf), % is undefined for negative operands
+int wrap(int i, int n)
+{
+    return (i + 2*n) % n;
+}
+
+vec4 map_at(int x, int row, ivec2 size)
+{
+    return texelFetch(exp_map, ivec2(wrap(x, size.x), wrap(row, size.y)), 0);
+}
+
+
+void main()
+{
+    ivec2 size = textureSize(exp_map, 0);
+    float per_texel = 6.28318531 / float(size.x);
+
+    // the center pixel itself has no direction, half a pixel out is as close
+    // as any pixel center gets
+    vec2 p = (f_st * 0.5) * frame_size;
+    float radius = max(length(p), 0.5);
+
+    // texel coordinates, centers at whole numbers
+    vec2 t = vec2(atan(p.y, p.x) / per_texel - 0.5, row_frac - log(radius) / per_texel);
+    ivec2 i = ivec2(floor(t));
+    vec2 f = t - vec2(i);
+
+    int row = row_base + i.y;
+    vec4 a = mix(map_at(i.x, row, size), map_at(i.x + 1, row, size), f.x);
+    vec4 b = mix(map_at(i.x, row + 1, size), map_at(i.x + 1, row + 1, size), f.x);
+    f_color = mix(a, b, f.y);
+}
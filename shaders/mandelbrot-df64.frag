@@ -0,0 +1,223 @@
+#version 330 core
+
+// the error terms below are zero in exact arithmetic, so compilers free to
+// reassociate fold them away unless they are `precise`; without it this
+// shader still compiles, but FractalRenderer will not pick it
+#ifdef GL_ARB_gpu_shader5
+#extension GL_ARB_gpu_shader5 : enable
+#define PRECISE precise
+#else
+#define PRECISE
+#endif
+
+precision highp float;
+
+
+in vec2 f_st;
+
+// escape count and smooth (continuous) escape count, colored by colorize.frag
+layout(location = 0) out vec2 f_iterations;
+
+// double-float (df64) numbers are a vec2 (hi, lo) of floats with value hi+lo,
+// giving about 48 bits of mantissa; complex numbers are a vec4 (re, im)
+uniform vec2 center_x = vec2(0.0, 0.0);
+uniform vec2 center_y = vec2(0.0, 0.0);
+uniform vec2 inv_zoom = vec2(2.5, 0.0);
+uniform float aspect = 1.0;
+
+
+// the program defines EXPONENT, an integer; polar powers are not worth
+// emulating
+#ifndef EXPONENT
+#define EXPONENT 2
+#endif
+uniform float thresh = 2.0;
+
+uniform uint max_steps = 1024u;
+
+// INTERIOR_CHECKS and DERIVATIVE_TEST as in mandelbrot.frag, the orbit is
+// compared in df64 and the derivative kept in float
+uniform float period_sqeps = 0.0;
+#define DERIVATIVE_SQEPS 1e-24
+
+
+// df64 arithmetic, after Dekker and the QD library
+
+// a + b exactly, as s + e
+vec2 two_sum(float a, float b)
+{
+    PRECISE float s = a + b;
+    PRECISE float v = s - a;
+    PRECISE float e = (a - (s - v)) + (b - v);
+    return vec2(s, e);
+}
+
+// same, if |a| >= |b|
+vec2 quick_two_sum(float a, float b)
+{
+    PRECISE float s = a + b;
+    PRECISE float e = b - (s - a);
+    return vec2(s, e);
+}
+
+// a into two 12-bit halves
+vec2 split(float a)
+{
+    PRECISE float t = 4097.0 * a;
+    PRECISE float hi = t - (t - a);
+    PRECISE float lo = a - hi;
+    return vec2(hi, lo);
+}
+
+// a * b exactly, as p + e
+vec2 two_prod(float a, float b)
+{
+    PRECISE float p = a * b;
+    vec2 as = split(a);
+    vec2 bs = split(b);
+    PRECISE float e = ((as.x*bs.x - p) + as.x*bs.y + as.y*bs.x) + as.y*bs.y;
+    return vec2(p, e);
+}
+
+vec2 df_add(vec2 a, vec2 b)
+{
+    vec2 s = two_sum(a.x, b.x);
+    s.y += a.y + b.y;
+    return quick_two_sum(s.x, s.y);
+}
+
+vec2 df_sub(vec2 a, vec2 b)
+{
+    return df_add(a, -b);
+}
+
+vec2 df_mul(vec2 a, vec2 b)
+{
+    vec2 p = two_prod(a.x, b.x);
+    p.y += a.x*b.y + a.y*b.x;
+    return quick_two_sum(p.x, p.y);
+}
+
+vec2 df_mul_f(vec2 a, float b)
+{
+    vec2 p = two_prod(a.x, b);
+    p.y += a.y*b;
+    return quick_two_sum(p.x, p.y);
+}
+
+
+// complex df64 operations
+
+vec4 compl_add(vec4 a, vec4 b)
+{
+    return vec4(df_add(a.xy, b.xy), df_add(a.zw, b.zw));
+}
+
+vec4 compl_mul(vec4 a, vec4 b)
+{
+    return vec4(
+        df_sub(df_mul(a.xy, b.xy), df_mul(a.zw, b.zw)),
+        df_add(df_mul(a.xy, b.zw), df_mul(a.zw, b.xy)));
+}
+
+vec4 compl_sqr(vec4 a)
+{
+    return vec4(
+        df_sub(df_mul(a.xy, a.xy), df_mul(a.zw, a.zw)),
+        df_mul_f(df_mul(a.xy, a.zw), 2.0));
+}
+
+
+// i + 1 - log_p(log|z| / log(thresh)), in (i, i+1] for escaped pixels
+float smooth_count(uint i, float abs_z, float power)
+{
+    if (i >= max_steps || thresh <= 1.0 || power <= 1.0) return float(i);
+    return float(i) + 1.0 - log(log(abs_z) / log(thresh)) / log(power);
+}
+
+
+#if defined(INTERIOR_CHECKS) && EXPONENT == 2
+// orbits of these points stay within |z| <= 2, the high parts are enough
+bool in_cardioid_or_bulb(vec2 c)
+{
+    float xq = c.x - 0.25;
+    float q = xq*xq + c.y*c.y;
+    if (q * (q + xq) <= 0.25 * c.y*c.y) return true;
+    return dot(c + vec2(1.0, 0.0), c + vec2(1.0, 0.0)) <= 0.0625;
+}
+#endif
+
+
+void main()
+{
+    // apply center translation, aspect, and zoom, all in df64
+    vec2 stx = df_add(df_mul_f(inv_zoom, aspect * f_st.x), center_x);
+    vec2 sty = df_add(df_mul_f(inv_zoom, f_st.y), center_y);
+    vec4 st = vec4(stx, sty);
+
+    // iterate, the escape test only needs the high parts
+    uint i = 0u;
+    vec4 z = st;
+    float sqthresh = thresh * thresh;
+
+#ifdef INTERIOR_CHECKS
+#if EXPONENT == 2
+    if (thresh >= 2.0 && in_cardioid_or_bulb(st.xz))
+        i = max_steps;
+#endif
+    // brent periodicity
+    vec4 saved = z;
+    uint window = 1u, age = 0u;
+#ifdef DERIVATIVE_TEST
+    vec2 dz = vec2(1.0, 0.0);
+#endif
+#endif
+
+    while (z.x*z.x + z.z*z.z < sqthresh && i < max_steps)
+    {
+#if defined(INTERIOR_CHECKS) && defined(DERIVATIVE_TEST)
+        // d(z^n + c)/dz0 = n z^(n-1) dz
+        vec2 zn1 = z.xz;
+        for (int e = 2; e < EXPONENT; e++)
+            zn1 = vec2(zn1.x*z.x - zn1.y*z.z, zn1.x*z.z + zn1.y*z.x);
+        dz = float(EXPONENT) * vec2(zn1.x*dz.x - zn1.y*dz.y, zn1.x*dz.y + zn1.y*dz.x);
+#endif
+
+#if EXPONENT == 2
+        z = compl_sqr(z);
+#else
+        // z^n by repeated multiplication, unrolled
+        vec4 b = z;
+        for (int e = 1; e < EXPONENT; e++)
+            z = compl_mul(z, b);
+#endif
+        z = compl_add(z, st);
+
+        i++;
+
+#ifdef INTERIOR_CHECKS
+        float dx = df_sub(z.xy, saved.xy).x;
+        float dy = df_sub(z.zw, saved.zw).x;
+        if (dx*dx + dy*dy < period_sqeps && z.x*z.x + z.z*z.z < sqthresh)
+        {
+            i = max_steps;
+            break;
+        }
+#ifdef DERIVATIVE_TEST
+        if (dot(dz, dz) < DERIVATIVE_SQEPS)
+        {
+            i = max_steps;
+            break;
+        }
+#endif
+        if (++age == window)
+        {
+            saved = z;
+            window *= 2u;
+            age = 0u;
+        }
+#endif
+    }
+
+    f_iterations = vec2(float(i), smooth_count(i, length(z.xz), float(EXPONENT)));
+}
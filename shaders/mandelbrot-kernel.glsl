@@ -0,0 +1,178 @@
+// escape time iteration shared by mandelbrot.frag and mandelbrot.comp, which
+// #include it after their #version and interface
+
+uniform vec2 center = vec2(0.0, 0.0);
+uniform float zoom = 0.4;
+uniform float aspect = 1.0;
+
+// of the view, in pixels
+uniform vec2 view_size = vec2(1.0, 1.0);
+
+
+// EXPONENT (an integer) may be defined by the program, which replaces the
+// polar path with an unrolled multiply-only kernel and leaves expon unused
+uniform float expon = 2.0;
+uniform float thresh = 2.0;
+
+uniform uint max_steps = 1024u;
+
+// INTERIOR_CHECKS may be defined to end interior pixels early: a closed form
+// test for the main cardioid and period-2 bulb of z^2 + c, and brent
+// periodicity checking, with an orbit that comes back within period_sqeps
+// (squared) of a saved point counted as never escaping; DERIVATIVE_TEST adds
+// an attracting orbit test on dz/dz0, for integer exponents only
+uniform float period_sqeps = 0.0;
+#define DERIVATIVE_SQEPS 1e-24
+
+
+// complex number operations
+
+vec2 compl_as_polar(vec2 c)
+{
+    float r = length(c);
+    float theta = acos(c.x / r);
+    if (c.y < 0.0) theta = -theta;
+    return vec2( r, theta );
+}
+
+vec2 polar_as_compl(vec2 p)
+{
+    float real = p.x * cos(p.y);
+    float imag = p.x * sin(p.y);
+    return vec2( real, imag );
+}
+
+vec2 compl_pow(vec2 c, float e)
+{
+    vec2 p = compl_as_polar(c);
+    vec2 powed = vec2( pow(p.x, e), e*p.y ); // { pow(p.r, e), e*pow.theta }
+    return polar_as_compl(powed);
+}
+
+vec2 compl_mul(vec2 a, vec2 b)
+{
+    return vec2(a.x*b.x - a.y*b.y, a.x*b.y + a.y*b.x);
+}
+
+#ifdef EXPONENT
+// z^EXPONENT, the loop has a constant bound and unrolls
+vec2 compl_pow_n(vec2 z)
+{
+#if EXPONENT == 2
+    return vec2(z.x*z.x - z.y*z.y, 2.0*z.x*z.y);
+#else
+    vec2 p = z;
+    for (int e = 1; e < EXPONENT; e++)
+        p = compl_mul(p, z);
+    return p;
+#endif
+}
+#endif
+
+
+// i + 1 - log_p(log|z| / log(thresh)), in (i, i+1] for escaped pixels
+float smooth_count(uint i, float abs_z, float power)
+{
+    if (i >= max_steps || thresh <= 1.0 || power <= 1.0) return float(i);
+    return float(i) + 1.0 - log(log(abs_z) / log(thresh)) / log(power);
+}
+
+
+#if defined(INTERIOR_CHECKS) && defined(EXPONENT) && EXPONENT == 2
+// orbits of these points stay within |z| <= 2
+bool in_cardioid_or_bulb(vec2 c)
+{
+    float xq = c.x - 0.25;
+    float q = xq*xq + c.y*c.y;
+    if (q * (q + xq) <= 0.25 * c.y*c.y) return true;
+    return dot(c + vec2(1.0, 0.0), c + vec2(1.0, 0.0)) <= 0.0625;
+}
+#endif
+
+
+// escape count and smooth escape count at a pixel center, in pixels from
+// the bottom left like gl_FragCoord.xy. both shaders start from the pixel
+// rather than an interpolated position, so they agree to the last bit
+vec2 escape_time(vec2 pixel_center)
+{
+    vec2 f_st = pixel_center / view_size * 2.0 - 1.0;
+
+    // apply center translation, aspect, and zoom
+    vec2 aspect_mul = vec2(aspect, 1.0);
+    vec2 st = aspect_mul * f_st / zoom + center;
+
+    // iterate
+    uint i = 0u;
+    vec2 z = st;
+    float sqthresh = thresh * thresh;
+
+#ifdef INTERIOR_CHECKS
+#if defined(EXPONENT) && EXPONENT == 2
+    if (thresh >= 2.0 && in_cardioid_or_bulb(st))
+        i = max_steps;
+#endif
+    // brent: compare against a saved point, saved again after windows of
+    // doubling length, so any cycle is eventually caught
+    vec2 saved = z;
+    uint window = 1u, age = 0u;
+#ifdef DERIVATIVE_TEST
+    vec2 dz = vec2(1.0, 0.0);
+#endif
+#endif
+
+    while (dot(z, z) < sqthresh && i < max_steps)
+    {
+#if defined(INTERIOR_CHECKS) && defined(DERIVATIVE_TEST) && defined(EXPONENT)
+        // d(z^n + c)/dz0 = n z^(n-1) dz
+#if EXPONENT == 2
+        dz = 2.0 * compl_mul(z, dz);
+#else
+        vec2 zn1 = z;
+        for (int e = 2; e < EXPONENT; e++)
+            zn1 = compl_mul(zn1, z);
+        dz = float(EXPONENT) * compl_mul(zn1, dz);
+#endif
+#endif
+
+        // // burning ship
+        // vec2 z_abs = vec2(abs(z.x), abs(z.y));
+        // z = compl_pow(z_abs, expon) + st;
+
+        // mandelbrot set
+#ifdef EXPONENT
+        z = compl_pow_n(z) + st;
+#else
+        z = compl_pow(z, expon) + st;
+#endif
+
+        i++;
+
+#ifdef INTERIOR_CHECKS
+        if (dot(z - saved, z - saved) < period_sqeps && dot(z, z) < sqthresh)
+        {
+            i = max_steps;
+            break;
+        }
+#if defined(DERIVATIVE_TEST) && defined(EXPONENT)
+        if (dot(dz, dz) < DERIVATIVE_SQEPS)
+        {
+            i = max_steps;
+            break;
+        }
+#endif
+        if (++age == window)
+        {
+            saved = z;
+            window *= 2u;
+            age = 0u;
+        }
+#endif
+    }
+
+#ifdef EXPONENT
+    return vec2(float(i), smooth_count(i, length(z), float(EXPONENT)));
+#else
+    return vec2(float(i), smooth_count(i, length(z), expon));
+#endif
+}
+
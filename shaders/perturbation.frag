@@ -0,0 +1,181 @@
+#version 330 core
+
+precision highp float;
+
+
+in vec2 f_st;
+
+// escape count and smooth (continuous) escape count, colored by colorize.frag
+layout(location = 0) out vec2 f_iterations;
+
+// reference orbit Z_n (z_0 = 0) of the view center, computed on the cpu in
+// high precision, point n at texel (n % orbit_width, n / orbit_width)
+uniform sampler2D orbit;
+uniform int orbit_len = 1;
+uniform int orbit_width = 1024;
+
+// this pixel's offset from the reference is
+//   dc = vec2(aspect, 1) * f_st * dc_scale * 2^dc_exp
+// which is far too small for a float at deep zooms, so deltas are kept as a
+// float mantissa plus an integer exponent until they grow large enough
+uniform float aspect = 1.0;
+uniform float dc_scale = 1.0;
+uniform int dc_exp = 0;
+
+#ifdef EXP_MAP
+// an exponential map instead: x goes once around the reference, and y
+// shrinks the radius from dc_scale * 2^dc_exp at the bottom by a factor of
+// e^log_height at the top
+uniform float log_height = 1.0;
+#endif
+
+uniform float thresh = 2.0;
+
+// bilinear approximations along the orbit, dz -> A dz + B dc skipping 2^l
+// steps from point n = 1 + k*2^l, entry k of level l at bla_offsets[l] + k;
+// each entry is two texels, (A, B) then (log2 of the valid radius, 0, 0, 0)
+uniform sampler2D bla;
+uniform bool use_bla = false;
+uniform int bla_width = 1024;
+uniform int bla_levels = 0;
+uniform int bla_offsets[24];
+uniform int bla_sizes[24];
+
+uniform uint max_steps = 1024u;
+
+
+vec2 compl_mul(vec2 a, vec2 b)
+{
+    return vec2(a.x*b.x - a.y*b.y, a.x*b.y + a.y*b.x);
+}
+
+// x * 2^k, with k clamped to the normal float range (ldexp needs glsl 4.0)
+vec2 scale2(vec2 x, int k)
+{
+    return x * exp2(float(clamp(k, -126, 126)));
+}
+
+vec2 ref_at(int n)
+{
+    return texelFetch(orbit, ivec2(n % orbit_width, n / orbit_width), 0).xy;
+}
+
+vec4 bla_at(int entry, int texel)
+{
+    int t = 2*entry + texel;
+    return texelFetch(bla, ivec2(t % bla_width, t / bla_width), 0);
+}
+
+// keep a scaled mantissa near 1, and drop the scaling once it fits a float
+void renormalize(inout vec2 w, inout int e, inout bool scaled)
+{
+    float mag = max(abs(w.x), abs(w.y));
+    if (mag > 256.0 || (mag < 1.0/256.0 && mag > 0.0))
+    {
+        int k = int(floor(log2(mag)));
+        w = scale2(w, -k);
+        e += k;
+    }
+
+    if (e > -64)
+    {
+        w = scale2(w, e);
+        scaled = false;
+    }
+}
+
+
+// i + 1 - log_p(log|z| / log(thresh)), in (i, i+1] for escaped pixels
+float smooth_count(uint i, float abs_z, float power)
+{
+    if (i >= max_steps || thresh <= 1.0 || power <= 1.0) return float(i);
+    return float(i) + 1.0 - log(log(abs_z) / log(thresh)) / log(power);
+}
+
+
+void main()
+{
+#ifdef EXP_MAP
+    float angle = 3.14159265 * (f_st.x + 1.0);
+    float radius = exp(-0.5 * (f_st.y + 1.0) * log_height);
+    vec2 d = radius * vec2(cos(angle), sin(angle)) * dc_scale;
+#else
+    vec2 d = vec2(aspect, 1.0) * f_st * dc_scale;
+#endif
+
+    // delta from the reference orbit, dz = w * 2^e while scaled
+    // mandelbrot.frag starts at z = c, which is z_1 = Z_1 + dc
+    vec2 w = d;
+    int e = dc_exp;
+    bool scaled = true;
+    int n = 1;
+
+    uint i = 0u;
+    vec2 z = vec2(0.0);
+    float sqthresh = thresh * thresh;
+    while (i < max_steps)
+    {
+        vec2 dz = scaled? scale2(w, e) : w;
+        z = ref_at(n) + dz;
+        float sqz = dot(z, z);
+        if (sqz >= sqthresh) break;
+
+        // glitch: this pixel's orbit got closer to 0 than its delta, so the
+        // reference no longer describes it (or the reference escaped); re-
+        // reference onto the start of the orbit, Z_0 = 0, where dz = z
+        if (n >= orbit_len - 1 || (!scaled && sqz < dot(w, w)))
+        {
+            w = z;
+            scaled = false;
+            n = 0;
+        }
+
+        // skip as many steps as the largest valid approximation allows;
+        // radii only shrink going up, so stop at the first that fails
+        if (use_bla && n > 0)
+        {
+            int we = scaled? e : 0;
+            float lg = log2(max(length(w), 1e-37)) + float(we);
+            int level = -1;
+            for (int l = 0; l < bla_levels; l++)
+            {
+                int k = (n - 1) >> l;
+                if (((n - 1) & ((1 << l) - 1)) != 0 || k >= bla_sizes[l]) break;
+                if (i + (1u << l) > max_steps) break;
+                if (!(lg < bla_at(bla_offsets[l] + k, 1).x)) break;
+                level = l;
+            }
+
+            // a single step is cheaper done exactly
+            if (level > 0)
+            {
+                vec4 ab = bla_at(bla_offsets[level] + ((n - 1) >> level), 0);
+                w = compl_mul(ab.xy, w) + compl_mul(ab.zw, scale2(d, dc_exp - we));
+                if (scaled) renormalize(w, e, scaled);
+                n += 1 << level;
+                i += 1u << level;
+                continue;
+            }
+        }
+
+        // dz' = 2 Z dz + dz^2 + dc
+        vec2 Z = ref_at(n);
+        if (scaled)
+        {
+            // w' = 2 Z w + w^2 2^e + d 2^(dc_exp - e)
+            w = 2.0 * compl_mul(Z, w)
+                + scale2(compl_mul(w, w), e)
+                + scale2(d, dc_exp - e);
+            renormalize(w, e, scaled);
+        }
+        else
+        {
+            w = 2.0 * compl_mul(Z, w) + compl_mul(w, w) + scale2(d, dc_exp);
+        }
+
+        n++;
+        i++;
+    }
+
+    f_iterations = vec2(float(i), smooth_count(i, length(z), 2.0));
+}
@@ -0,0 +1,28 @@
+#version 330 core
+
+in vec2 f_texcoord;
+flat in int f_unit;
+
+// QuadBatch::TEXTURE_UNITS
+uniform sampler2D textures[16];
+
+layout(location = 0) out vec4 f_color;
+
+
+// glsl 3.30 only indexes sampler arrays with constants, and implicit lods
+// are undefined in branches that differ between pixels, so each unit is a
+// case sampling with gradients taken outside the switch
+#define SAMPLE(i) case i: f_color = textureGrad(textures[i], f_texcoord, dx, dy); break;
+
+void main()
+{
+    vec2 dx = dFdx(f_texcoord), dy = dFdy(f_texcoord);
+    switch (f_unit)
+    {
+        SAMPLE(0)  SAMPLE(1)  SAMPLE(2)  SAMPLE(3)
+        SAMPLE(4)  SAMPLE(5)  SAMPLE(6)  SAMPLE(7)
+        SAMPLE(8)  SAMPLE(9)  SAMPLE(10) SAMPLE(11)
+        SAMPLE(12) SAMPLE(13) SAMPLE(14) SAMPLE(15)
+        default: f_color = vec4(1.0, 0.0, 1.0, 1.0); break;
+    }
+}
@@ -0,0 +1,30 @@
+#version 330 core
+
+// one quad per instance, see QuadBatch::QuadInstance
+layout(location = 0) in vec4 v_rect; // x, y, width, height, in pixels from the top left
+layout(location = 1) in float v_z;
+layout(location = 2) in int v_unit;
+
+uniform ivec2 screen_size;
+
+out vec2 f_texcoord;
+flat out int f_unit;
+
+// two triangles, as in RenderTarget's quad
+const vec2 corners[6] = vec2[6](
+    vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0),
+    vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(1.0, 0.0));
+
+
+void main()
+{
+    vec2 corner = corners[gl_VertexID];
+
+    // textures are stored bottom row first, as render_texture() expects
+    f_texcoord = vec2(corner.x, 1.0 - corner.y);
+    f_unit = v_unit;
+
+    // remap screen-space (y down) to clip-space (y up)
+    vec2 position = (v_rect.xy + corner * v_rect.zw) / vec2(screen_size);
+    gl_Position = vec4(2.0 * position.x - 1.0, 1.0 - 2.0 * position.y, v_z, 1.0);
+}
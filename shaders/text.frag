@@ -0,0 +1,14 @@
+#version 330 core
+
+in vec2 f_texcoord;
+
+uniform sampler2D atlas;
+
+layout(location = 0) out vec4 f_color;
+
+
+void main()
+{
+    // coverage to white on black
+    f_color = vec4(vec3(texture(atlas, f_texcoord).r), 1.0);
+}
@@ -0,0 +1,26 @@
+#version 330 core
+
+// one quad per character, see Font::GlyphInstance
+layout(location = 0) in vec4 v_rect;    // x, y, width, height, in pixels from the top left
+layout(location = 1) in vec4 v_texrect; // u, v, du, dv in the atlas
+
+uniform ivec2 screen_size;
+uniform float z;
+
+out vec2 f_texcoord;
+
+// two triangles, as in RenderTarget's quad
+const vec2 corners[6] = vec2[6](
+    vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0),
+    vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(1.0, 0.0));
+
+
+void main()
+{
+    vec2 corner = corners[gl_VertexID];
+    f_texcoord = v_texrect.xy + corner * v_texrect.zw;
+
+    // remap screen-space (y down) to clip-space (y up)
+    vec2 position = (v_rect.xy + corner * v_rect.zw) / vec2(screen_size);
+    gl_Position = vec4(2.0 * position.x - 1.0, 1.0 - 2.0 * position.y, z, 1.0);
+}
@@ -0,0 +1,370 @@
+// mandelbrot-bench: times a fixed set of views on the gpu and cpu paths, and
+// prints the results as json so runs can be compared over time
+//
+// every view is rendered at each size and iteration limit on the gpu (the
+// shader FractalRenderer picks for it, and for float views the compute path
+// with and without tile ordering) and with every cpu kernel this machine
+// runs, on all threads. each timing is the median of --repeat runs,
+// after one untimed run that compiles shaders and computes reference orbits
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include "escape-time.hpp"
+#include "fractal-renderer.hpp"
+#include "headless-context.hpp"
+#include "mariani-silver.hpp"
+#include "rendertarget.hpp"
+#include "tile-scheduler.hpp"
+#include "view.hpp"
+
+
+
+static const char* const USAGE =
+    "usage: mandelbrot-bench [options]\n"
+    "\n"
+    "  --repeat N         timed runs per case, the median is reported (3)\n"
+    "  --only NAME        only views whose name contains NAME\n"
+    "  --quick            smallest size and iteration limit only\n"
+    "  --no-gpu           skip the shaders\n"
+    "  --no-compute       skip the compute shader path\n"
+    "  --no-cpu           skip the cpu kernels\n"
+    "  --output FILE      write the json to FILE instead of stdout\n";
+
+
+struct BenchView
+{
+    const char* name;
+    const char* centerx;
+    const char* centery;
+    double zoom;
+    double exponent;
+};
+
+// canonical locations, from cheap to expensive per pixel
+static const BenchView VIEWS[] =
+{
+    { "home",      "0",                  "0",                 0.4,    2.0 },
+    { "seahorse",  "-0.743643887037151", "0.131825904205330", 5000.0, 2.0 },
+    { "elephant",  "0.2925",             "0.0149",            200.0,  2.0 },
+    { "minibrot",  "-1.7548776662466927", "0",                60.0,   2.0 },
+    // entirely inside the main cardioid, every pixel runs to max_steps
+    // unless an interior test ends it
+    { "interior",  "-0.2",               "0",                 8.0,    2.0 },
+    { "cubic",     "0",                  "0",                 0.4,    3.0 },
+};
+
+struct BenchSize
+{
+    int width, height;
+};
+
+static const BenchSize SIZES[] = { { 640, 360 }, { 1920, 1080 } };
+static const uint32_t MAX_STEPS[] = { 256, 4096 };
+
+
+struct BenchResult
+{
+    std::string backend; // "gpu" or "cpu"
+    std::string path;    // shader mode (-compute for the compute path), or cpu kernel
+    std::string view;
+    int width = 0, height = 0;
+    uint32_t max_steps = 0;
+
+    double wall_ms = 0.0;
+    double gpu_ms = -1.0; // gpu only
+    // sum of every pixel's escape count: what a renderer without interior
+    // tests iterates, so faster early-outs show up as more iterations/s
+    uint64_t iterations = 0;
+};
+
+
+static double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    const std::size_t n = values.size();
+    return (n % 2)? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+// json has no inf or nan, and results are never negative
+static std::string json_number(double value)
+{
+    if (!(value >= 0.0) || value > 1e300) return "null";
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.6g", value);
+    return buf;
+}
+
+static std::string json_string(const std::string& text)
+{
+    std::string out = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\') out += '\\';
+        if ((unsigned char)c < 0x20) continue;
+        out += c;
+    }
+    return out + "\"";
+}
+
+
+// time FractalRenderer on view, with the escape counts read back once.
+// compute uses its compute path instead, with tiles ordered by cost or not
+static BenchResult bench_gpu(FractalRenderer& fractal, const View& view, int repeat, GLuint query, bool compute, bool ordered)
+{
+    RenderTarget target(view.width, view.height, GL_RG32F);
+
+    BenchResult result;
+    result.backend = "gpu";
+    result.path = fractal_mode_name(fractal.mode_for(view));
+    if (compute) result.path += ordered? "-compute-ordered" : "-compute";
+
+    fractal.set_tile_ordering(ordered);
+    const auto draw = [&]
+    {
+        if (compute)
+            fractal.draw_compute(view, target.color_texture());
+        else
+        {
+            target.use();
+            fractal.draw(view);
+        }
+    };
+
+    // compile and upload outside the timings, and cost the tiles
+    draw();
+    glFinish();
+
+    std::vector<double> wall, gpu;
+    for (int i = 0; i < repeat; i++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        draw();
+        glEndQuery(GL_TIME_ELAPSED);
+        glFinish();
+        wall.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count());
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+        gpu.push_back(ns * 1e-6);
+    }
+    result.wall_ms = median(wall);
+    result.gpu_ms = median(gpu);
+
+    std::vector<float> counts((std::size_t)view.width * view.height * 2);
+    target.use();
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, view.width, view.height, GL_RG, GL_FLOAT, counts.data());
+    for (std::size_t i = 0; i < counts.size(); i += 2)
+        result.iterations += (uint64_t)counts[i];
+
+    return result;
+}
+
+// time a cpu kernel on view, tiled over every thread; subdivide uses
+// Mariani-Silver instead of iterating every pixel
+static BenchResult bench_cpu(TileScheduler& scheduler, SimdLevel level, bool subdivide, const View& view, int repeat)
+{
+    const EscapeTime engine(level);
+    const FractalParams params = view.params();
+    std::vector<uint32_t> counts((std::size_t)view.width * view.height);
+
+    BenchResult result;
+    result.backend = "cpu";
+    result.path = simd_level_name(engine.level());
+    if (subdivide) result.path += "-subdivided";
+
+    const auto run = [&]
+    {
+        if (subdivide)
+            render_subdivided(scheduler, engine, params, view.width, view.height, counts.data());
+        else
+            render_tiled(scheduler, engine, params, view.width, view.height, counts.data());
+    };
+    run();
+
+    std::vector<double> wall;
+    for (int i = 0; i < repeat; i++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        wall.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+    result.wall_ms = median(wall);
+
+    for (uint32_t count : counts)
+        result.iterations += count;
+    return result;
+}
+
+
+static void write_json(std::ostream& os, const std::string& renderer, unsigned threads, int repeat, const std::vector<BenchResult>& results)
+{
+    os << "{\n"
+        << "  \"renderer\": " << json_string(renderer) << ",\n"
+        << "  \"cpu_threads\": " << threads << ",\n"
+        << "  \"cpu_simd\": " << json_string(simd_level_name(detect_simd_level())) << ",\n"
+        << "  \"repeat\": " << repeat << ",\n"
+        << "  \"results\": [";
+
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult& r = results[i];
+        const double pixels = (double)r.width * r.height;
+        const double seconds = r.wall_ms * 1e-3;
+
+        os << (i? ",\n" : "\n")
+            << "    {\"backend\": " << json_string(r.backend)
+            << ", \"path\": " << json_string(r.path)
+            << ", \"view\": " << json_string(r.view)
+            << ", \"width\": " << r.width
+            << ", \"height\": " << r.height
+            << ", \"max_steps\": " << r.max_steps
+            << ", \"wall_ms\": " << json_number(r.wall_ms)
+            << ", \"gpu_ms\": " << json_number(r.gpu_ms)
+            << ", \"pixels_per_sec\": " << json_number(pixels / seconds)
+            << ", \"iterations\": " << r.iterations
+            << ", \"iterations_per_sec\": " << json_number(r.iterations / seconds)
+            << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+
+int main(int argc, char** argv)
+{
+    int repeat = 3;
+    std::string only, output;
+    bool quick = false, gpu = true, compute = true, cpu = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string opt = argv[i];
+        if (opt == "--help" || opt == "-h")
+        {
+            std::cout << USAGE;
+            return 0;
+        }
+        else if (opt == "--repeat" && i + 1 < argc)
+        {
+            repeat = atoi(argv[++i]);
+            if (repeat < 1)
+            {
+                std::cerr << "bad number for --repeat: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (opt == "--only" && i + 1 < argc)
+            only = argv[++i];
+        else if (opt == "--output" && i + 1 < argc)
+            output = argv[++i];
+        else if (opt == "--quick")
+            quick = true;
+        else if (opt == "--no-gpu")
+            gpu = false;
+        else if (opt == "--no-compute")
+            compute = false;
+        else if (opt == "--no-cpu")
+            cpu = false;
+        else
+        {
+            std::cerr << "unknown option " << opt << "\n\n" << USAGE;
+            return 1;
+        }
+    }
+
+    HeadlessContext context;
+    FractalRenderer fractal;
+    TileScheduler scheduler;
+
+    GLuint query = 0;
+    glGenQueries(1, &query);
+
+    // every kernel up to the best this cpu runs
+    std::vector<SimdLevel> levels = { SimdLevel::Scalar };
+    if (detect_simd_level() >= SimdLevel::AVX2) levels.push_back(SimdLevel::AVX2);
+    if (detect_simd_level() >= SimdLevel::AVX512) levels.push_back(SimdLevel::AVX512);
+
+    std::vector<BenchResult> results;
+    for (const BenchView& bv : VIEWS)
+    {
+        if (std::string(bv.name).find(only) == std::string::npos) continue;
+
+        for (const BenchSize& size : SIZES)
+        for (uint32_t max_steps : MAX_STEPS)
+        {
+            if (quick && (&size != SIZES || max_steps != MAX_STEPS[0])) continue;
+
+            View view;
+            BigFixed::parse(bv.centerx, view.centerx);
+            BigFixed::parse(bv.centery, view.centery);
+            view.zoom = bv.zoom;
+            view.exponent = bv.exponent;
+            view.max_steps = max_steps;
+            view.width = size.width;
+            view.height = size.height;
+
+            std::vector<BenchResult> cases;
+            if (gpu)
+                cases.push_back(bench_gpu(fractal, view, repeat, query, false, false));
+            // the compute path only has the float shader
+            if (gpu && compute && fractal.compute_supported()
+                && fractal.mode_for(view) == FractalMode::Float)
+            {
+                cases.push_back(bench_gpu(fractal, view, repeat, query, true, false));
+                cases.push_back(bench_gpu(fractal, view, repeat, query, true, true));
+            }
+            if (cpu)
+            {
+                for (SimdLevel level : levels)
+                    cases.push_back(bench_cpu(scheduler, level, false, view, repeat));
+                cases.push_back(bench_cpu(scheduler, levels.back(), true, view, repeat));
+            }
+
+            for (BenchResult& r : cases)
+            {
+                r.view = bv.name;
+                r.width = view.width;
+                r.height = view.height;
+                r.max_steps = view.max_steps;
+
+                // progress on stderr, the json may be going to stdout
+                std::cerr << bv.name << " " << r.width << "x" << r.height
+                    << " " << r.max_steps << " steps, " << r.backend << " "
+                    << r.path << ": " << r.wall_ms << "ms" << std::endl;
+                results.push_back(r);
+            }
+        }
+    }
+
+    glDeleteQueries(1, &query);
+
+    if (output.empty())
+    {
+        write_json(std::cout, context.renderer(), scheduler.thread_count(), repeat, results);
+        return 0;
+    }
+
+    std::ofstream file(output);
+    write_json(file, context.renderer(), scheduler.thread_count(), repeat, results);
+    file.close();
+    if (!file)
+    {
+        std::cerr << "could not write " << output << std::endl;
+        return 1;
+    }
+    return 0;
+}
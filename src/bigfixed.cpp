@@ -0,0 +1,254 @@
+#include "bigfixed.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+
+BigFixed::BigFixed(double value, int frac_limbs) :
+    m_negative(value < 0.0),
+    m_limbs(std::max(frac_limbs, 0) + 1, 0)
+{
+    // every step here is exact: scaling by 2^32 and taking the floor of a
+    // double never rounds, so the conversion keeps all 53 bits
+    double v = std::abs(value);
+    if (!(v < 4294967296.0))
+        v = 4294967295.0; // clamp to the integer limb (also catches nan)
+
+    for (std::size_t i = 0; i < m_limbs.size() && v > 0.0; i++)
+    {
+        const double limb = std::floor(v);
+        m_limbs[i] = (uint32_t)limb;
+        v = (v - limb) * 4294967296.0;
+    }
+
+    if (is_zero()) m_negative = false;
+}
+
+bool BigFixed::parse(std::string_view text, BigFixed& out, int frac_limbs)
+{
+    std::size_t i = 0;
+    const auto is_digit = [&](std::size_t k) { return k < text.size() && text[k] >= '0' && text[k] <= '9'; };
+
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+        negative = text[i++] == '-';
+
+    uint64_t integer = 0;
+    bool any_digits = false;
+    for (; is_digit(i); i++)
+    {
+        integer = integer * 10 + (text[i] - '0');
+        if (integer > UINT32_MAX) return false;
+        any_digits = true;
+    }
+
+    BigFixed value(0.0, frac_limbs);
+    if (i < text.size() && text[i] == '.')
+    {
+        const std::size_t first = ++i;
+        while (is_digit(i)) i++;
+        any_digits |= i > first;
+
+        // horner's rule from the last digit, fraction = (fraction + d) / 10,
+        // with a long division by 10 over the limbs
+        for (std::size_t k = i; k-- > first;)
+        {
+            value.m_limbs[0] += text[k] - '0';
+            uint64_t remainder = 0;
+            for (uint32_t& limb : value.m_limbs)
+            {
+                const uint64_t cur = (remainder << 32) | limb;
+                limb = (uint32_t)(cur / 10);
+                remainder = cur % 10;
+            }
+        }
+    }
+    if (!any_digits || i != text.size()) return false;
+
+    value.m_limbs[0] = (uint32_t)integer;
+    value.m_negative = negative && !value.is_zero();
+    out = std::move(value);
+    return true;
+}
+
+void BigFixed::set_precision(int frac_limbs)
+{
+    m_limbs.resize(std::max(frac_limbs, 0) + 1, 0);
+    if (is_zero()) m_negative = false;
+}
+
+double BigFixed::to_double(void) const
+{
+    // only the top few nonzero limbs can affect a double, sum those
+    // smallest first and then shift them into place
+    std::size_t first = 0;
+    while (first < m_limbs.size() && m_limbs[first] == 0)
+        first++;
+    if (first == m_limbs.size()) return 0.0;
+
+    const std::size_t last = std::min(m_limbs.size(), first + 3);
+    double value = 0.0;
+    for (std::size_t i = last; i-- > first;)
+        value = value / 4294967296.0 + m_limbs[i];
+    value = std::ldexp(value, -32 * (int)first);
+    return m_negative? -value : value;
+}
+
+std::string BigFixed::to_string(void) const
+{
+    // limbs are 2^-32 apart, a bit more than 1e-10, so 10 digits per limb
+    // keeps distinct values distinct
+    std::vector<uint32_t> fraction(m_limbs.begin() + 1, m_limbs.end());
+    std::string digits;
+    for (int d = 0; d < 10 * precision(); d++)
+    {
+        // multiply the fraction by 10, the carry out is the next digit
+        uint64_t carry = 0;
+        for (std::size_t k = fraction.size(); k-- > 0;)
+        {
+            const uint64_t cur = (uint64_t)fraction[k] * 10 + carry;
+            fraction[k] = (uint32_t)cur;
+            carry = cur >> 32;
+        }
+        digits += (char)('0' + carry);
+    }
+
+    // round the magnitude up, so parse (which truncates) gives this back
+    uint64_t integer = m_limbs[0];
+    if (std::any_of(fraction.begin(), fraction.end(), [](uint32_t limb) { return limb != 0; }))
+    {
+        std::size_t k = digits.size();
+        while (k > 0 && digits[k - 1] == '9')
+            digits[--k] = '0';
+        if (k > 0) digits[k - 1]++;
+        else integer++;
+    }
+
+    digits.erase(digits.find_last_not_of('0') + 1);
+    std::string text = m_negative? "-" : "";
+    text += std::to_string(integer);
+    if (!digits.empty())
+        text += "." + digits;
+    return text;
+}
+
+bool BigFixed::is_zero(void) const
+{
+    for (uint32_t limb : m_limbs)
+        if (limb) return false;
+    return true;
+}
+
+
+BigFixed BigFixed::operator-(void) const
+{
+    BigFixed result = *this;
+    if (!result.is_zero())
+        result.m_negative = !result.m_negative;
+    return result;
+}
+
+int BigFixed::compare_magnitude(const BigFixed& a, const BigFixed& b)
+{
+    for (std::size_t i = 0; i < a.m_limbs.size(); i++)
+        if (a.m_limbs[i] != b.m_limbs[i])
+            return (a.m_limbs[i] < b.m_limbs[i])? -1 : 1;
+    return 0;
+}
+
+BigFixed BigFixed::add_signed(const BigFixed& lhs, const BigFixed& rhs, bool negate_rhs)
+{
+    // bring both operands to the same precision
+    const int prec = std::max(lhs.precision(), rhs.precision());
+    BigFixed a = lhs, b = rhs;
+    a.set_precision(prec);
+    b.set_precision(prec);
+    if (negate_rhs) b.m_negative = !b.m_negative;
+
+    const std::size_t n = a.m_limbs.size();
+    BigFixed result(0.0, prec);
+
+    if (a.m_negative == b.m_negative)
+    {
+        // same sign, add magnitudes
+        uint64_t carry = 0;
+        for (std::size_t i = n; i-- > 0;)
+        {
+            const uint64_t sum = (uint64_t)a.m_limbs[i] + b.m_limbs[i] + carry;
+            result.m_limbs[i] = (uint32_t)sum;
+            carry = sum >> 32;
+        }
+        result.m_negative = a.m_negative;
+    }
+    else
+    {
+        // different signs, subtract the smaller magnitude from the larger
+        const bool a_larger = compare_magnitude(a, b) >= 0;
+        const BigFixed& big = a_larger? a : b;
+        const BigFixed& small = a_larger? b : a;
+
+        int64_t borrow = 0;
+        for (std::size_t i = n; i-- > 0;)
+        {
+            int64_t diff = (int64_t)big.m_limbs[i] - small.m_limbs[i] - borrow;
+            borrow = diff < 0;
+            if (borrow) diff += (int64_t)1 << 32;
+            result.m_limbs[i] = (uint32_t)diff;
+        }
+        result.m_negative = big.m_negative;
+    }
+
+    if (result.is_zero()) result.m_negative = false;
+    return result;
+}
+
+BigFixed BigFixed::operator+(const BigFixed& rhs) const
+{ return add_signed(*this, rhs, false); }
+
+BigFixed BigFixed::operator-(const BigFixed& rhs) const
+{ return add_signed(*this, rhs, true); }
+
+BigFixed BigFixed::operator*(const BigFixed& rhs) const
+{
+    const int prec = std::max(precision(), rhs.precision());
+    BigFixed a = *this, b = rhs;
+    a.set_precision(prec);
+    b.set_precision(prec);
+
+    // schoolbook product, keeping columns 0..prec plus one guard column;
+    // column k holds sum(a[i]*b[j]) for i+j == k
+    const int n = prec + 1;
+    std::vector<uint32_t> columns(n + 1, 0);
+
+    uint64_t carry = 0; // carry into the next column
+    for (int k = n; k >= 0; k--)
+    {
+        // 96-bit column sum, hi counts overflows of lo
+        uint64_t lo = carry;
+        uint32_t hi = 0;
+        for (int i = std::max(0, k - (n - 1)); i <= std::min(k, n - 1); i++)
+        {
+            const uint64_t p = (uint64_t)a.m_limbs[i] * b.m_limbs[k - i];
+            lo += p;
+            if (lo < p) hi++;
+        }
+        columns[k] = (uint32_t)lo;
+        carry = (lo >> 32) | ((uint64_t)hi << 32);
+    }
+    // carry out of column 0 overflows the integer limb and is dropped
+
+    BigFixed result(0.0, prec);
+    std::copy(columns.begin(), columns.begin() + n, result.m_limbs.begin());
+    result.m_negative = (a.m_negative != b.m_negative) && !result.is_zero();
+    return result;
+}
+
+bool BigFixed::operator==(const BigFixed& rhs) const
+{
+    const int prec = std::max(precision(), rhs.precision());
+    BigFixed a = *this, b = rhs;
+    a.set_precision(prec);
+    b.set_precision(prec);
+    return a.m_negative == b.m_negative && a.m_limbs == b.m_limbs;
+}
@@ -0,0 +1,71 @@
+#ifndef BIGFIXEDH
+#define BIGFIXEDH
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+// arbitrary precision signed fixed-point number, for deep zoom centers and
+// reference orbits where double runs out of bits
+//
+// stored as sign + magnitude, in 32-bit limbs, most significant first:
+// limb 0 is the integer part and limbs 1..n are the fraction, so the value
+// is sum(limb[i] * 2^(-32*i))
+class BigFixed
+{
+public:
+    // enough fraction bits for zooms past 1e300
+    constexpr static int DEFAULT_LIMBS = 34;
+
+    BigFixed(void) : BigFixed(0.0) {}
+    explicit BigFixed(double value, int frac_limbs = DEFAULT_LIMBS);
+
+    // a decimal like "-1.7548776662466927", exact up to frac_limbs; false
+    // (and out untouched) if text is not one or the integer part is too big
+    static bool parse(std::string_view text, BigFixed& out, int frac_limbs = DEFAULT_LIMBS);
+
+public:
+    // number of 32-bit fraction limbs
+    int precision(void) const { return (int)m_limbs.size() - 1; }
+    // truncate or zero-extend the fraction
+    void set_precision(int frac_limbs);
+
+    double to_double(void) const;
+    // decimal, with enough digits that no two values of this precision
+    // print the same
+    std::string to_string(void) const;
+    bool is_negative(void) const { return m_negative; }
+
+    BigFixed operator-(void) const;
+
+    // results have the precision of the more precise operand
+    BigFixed operator+(const BigFixed& rhs) const;
+    BigFixed operator-(const BigFixed& rhs) const;
+    BigFixed operator*(const BigFixed& rhs) const;
+
+    BigFixed& operator+=(const BigFixed& rhs) { return *this = *this + rhs; }
+    BigFixed& operator-=(const BigFixed& rhs) { return *this = *this - rhs; }
+    BigFixed& operator*=(const BigFixed& rhs) { return *this = *this * rhs; }
+
+    // doubles are converted at this number's precision
+    BigFixed& operator+=(double rhs) { return *this += BigFixed(rhs, precision()); }
+    BigFixed& operator-=(double rhs) { return *this -= BigFixed(rhs, precision()); }
+
+    // compares values, ignoring precision
+    bool operator==(const BigFixed& rhs) const;
+
+private:
+    // magnitude helpers, both operands must have n limbs
+    static int compare_magnitude(const BigFixed& a, const BigFixed& b);
+    static BigFixed add_signed(const BigFixed& a, const BigFixed& b, bool negate_b);
+
+    bool is_zero(void) const;
+
+private:
+    bool m_negative = false;
+    std::vector<uint32_t> m_limbs;
+};
+
+#endif // BIGFIXEDH
@@ -0,0 +1,68 @@
+#include "bla-table.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+void BlaTable::build(const ReferenceOrbit& orbit, double dc_max, double epsilon)
+{
+    m_entries.clear();
+    m_level_offsets.clear();
+    m_level_sizes.clear();
+
+    // level 0: single steps from point m = 1 .. size-2, each needs Z_m
+    // and a point m+1 to land on
+    if (orbit.size() < 3) return;
+    const size_t steps = orbit.size() - 2;
+
+    m_level_offsets.push_back(0);
+    m_level_sizes.push_back(steps);
+    for (size_t k = 0; k < steps; k++)
+    {
+        const size_t m = 1 + k;
+
+        // dropping dz^2 is fine while |dz|^2 < epsilon |2 Z dz|
+        BlaEntry e;
+        e.ax = 2.0 * orbit.x(m);
+        e.ay = 2.0 * orbit.y(m);
+        e.bx = 1.0;
+        e.by = 0.0;
+        e.r = epsilon * std::hypot(e.ax, e.ay);
+        m_entries.push_back(e);
+    }
+
+    // level l: merge pairs of level l-1 entries, x then y
+    while (m_level_sizes.back() >= 2)
+    {
+        const size_t prev_offset = m_level_offsets.back();
+        const size_t size = m_level_sizes.back() / 2;
+        m_level_offsets.push_back(m_entries.size());
+        m_level_sizes.push_back(size);
+
+        for (size_t k = 0; k < size; k++)
+        {
+            const BlaEntry x = m_entries[prev_offset + 2*k];
+            const BlaEntry y = m_entries[prev_offset + 2*k + 1];
+
+            BlaEntry e;
+            if (x.r > 0.0 && y.r > 0.0)
+            {
+                // A = Ay Ax, B = Ay Bx + By
+                e.ax = y.ax*x.ax - y.ay*x.ay;
+                e.ay = y.ax*x.ay + y.ay*x.ax;
+                e.bx = y.ax*x.bx - y.ay*x.by + y.bx;
+                e.by = y.ax*x.by + y.ay*x.bx + y.by;
+
+                // y applies to Ax dz + Bx dc, which must stay within ry
+                const double ax = std::hypot(x.ax, x.ay);
+                const double bx = std::hypot(x.bx, x.by);
+                e.r = std::min(x.r, std::max(0.0, (y.r - bx * dc_max) / ax));
+
+                if (std::hypot(e.ax, e.ay) > MAX_COEFFICIENT
+                    || std::hypot(e.bx, e.by) > MAX_COEFFICIENT)
+                    e = BlaEntry{};
+            }
+            m_entries.push_back(e);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef BLATABLEH
+#define BLATABLEH
+
+#include <stddef.h>
+#include <vector>
+
+#include "reference-orbit.hpp"
+
+
+// one bilinear approximation, skipping `length` iterations of
+//   dz' = 2 Z dz + dz^2 + dc
+// as dz' = A dz + B dc, valid while |dz| < r
+struct BlaEntry
+{
+    double ax = 0.0, ay = 0.0;
+    double bx = 0.0, by = 0.0;
+    double r = 0.0; // 0 if the entry must never be used
+};
+
+
+// bilinear approximations along a reference orbit, merged into levels
+//
+// level l entry k starts at orbit point 1 + k*2^l and skips 2^l iterations;
+// radii never grow going up a level, so a pixel can search upwards from
+// level 0 and stop at the first entry its delta does not fit
+class BlaTable
+{
+public:
+    // coefficients this large would overflow the float shader
+    constexpr static double MAX_COEFFICIENT = 0x1p100;
+
+    // dc_max is the largest |dc| of any pixel in the frame, epsilon the
+    // relative error allowed per skipped step
+    void build(const ReferenceOrbit& orbit, double dc_max, double epsilon);
+
+    size_t level_count(void) const { return m_level_offsets.size(); }
+    size_t level_offset(size_t level) const { return m_level_offsets[level]; }
+    size_t level_size(size_t level) const { return m_level_sizes[level]; }
+
+    // every level, back to back
+    const std::vector<BlaEntry>& entries(void) const { return m_entries; }
+
+private:
+    std::vector<BlaEntry> m_entries;
+    std::vector<size_t> m_level_offsets, m_level_sizes;
+};
+
+#endif // BLATABLEH
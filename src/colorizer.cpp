@@ -0,0 +1,53 @@
+#include "colorizer.hpp"
+
+#include "gl-state.hpp"
+
+
+namespace {
+
+static const float s_quad_vertices[] =
+{
+    // position
+    -1.0f,  1.0f,
+    -1.0f, -1.0f,
+     1.0f, -1.0f,
+
+    -1.0f,  1.0f,
+     1.0f, -1.0f,
+     1.0f,  1.0f
+};
+
+} // anonymous namespace
+
+
+Colorizer::Colorizer(void) :
+    m_prog(
+        std::filesystem::path{"shaders/mandelbrot.vert"},
+        std::filesystem::path{"shaders/colorize.frag"})
+{
+    m_vao.add_vertex_buffer(2*sizeof(float), 0);
+    auto& vbo = m_vao.get_buffer(0);
+    vbo.add_attrib(2, GL_FLOAT); // vec2 v_position
+    vbo.bind_data((void*)s_quad_vertices, 6, GL_STATIC_DRAW);
+
+    m_unif_smooth = m_prog.get_uniform("smooth_coloring");
+
+    // iterations sampler reads from slot 0
+    m_prog.use();
+    glUniform1i(m_prog.get_uniform("iterations"), 0);
+}
+
+void Colorizer::draw(const Texture& iterations)
+{
+    GLState::current().set_enabled(GL_DEPTH_TEST, false);
+    GLState::current().set_enabled(GL_BLEND, false);
+
+    m_prog.use();
+    glUniform1i(m_unif_smooth, m_smooth);
+
+    GLState::current().active_texture(0);
+    iterations.use();
+
+    m_vao.use();
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
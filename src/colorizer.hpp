@@ -0,0 +1,34 @@
+#ifndef COLORIZERH
+#define COLORIZERH
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include "program.hpp"
+#include "texture.hpp"
+#include "vertex-array.hpp"
+
+
+// second pass of the fractal pipeline: turns the iteration counts the
+// FractalRenderer stored into palette colors, without iterating again
+class Colorizer
+{
+public:
+    Colorizer(void);
+
+public:
+    bool smooth(void) const { return m_smooth; }
+    void set_smooth(bool smooth) { m_smooth = smooth; }
+
+    // fill the bound RenderTarget from an RG32F iteration texture
+    void draw(const Texture& iterations);
+
+private:
+    VertexArray m_vao;
+    Program m_prog;
+    GLint m_unif_smooth = -1;
+
+    bool m_smooth = false;
+};
+
+#endif // COLORIZERH
@@ -0,0 +1,64 @@
+#include "cpu-renderer.hpp"
+
+
+CpuRenderer::CpuRenderer(void) :
+    m_texture(GL_RG32F)
+{
+    // read with texelFetch, and must not need mipmaps
+    m_texture.use();
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+
+void CpuRenderer::set_interior_checks(bool enabled)
+{
+    if (enabled == m_interior_checks) return;
+    m_interior_checks = enabled;
+    m_valid = false;
+}
+
+FractalParams CpuRenderer::params(const View& view) const
+{
+    FractalParams p = view.params();
+    p.interior_checks = m_interior_checks;
+    return p;
+}
+
+
+void CpuRenderer::update(const View& view)
+{
+    if (m_valid && view == m_view) return;
+
+    m_view = view;
+    m_valid = true;
+
+    const std::size_t pixels = (std::size_t)view.width * view.height;
+    m_counts.resize(pixels);
+    m_stats = render_subdivided(
+        m_scheduler, m_engine, params(view),
+        view.width, view.height,
+        m_counts.data());
+
+    // same layout as the gpu's RG32F targets: (count, smooth count)
+    m_texels.resize(2 * pixels);
+    for (std::size_t i = 0; i < pixels; i++)
+    {
+        m_texels[2*i + 0] = (float)m_counts[i];
+        m_texels[2*i + 1] = (float)m_counts[i];
+    }
+    m_texture.set_pixels(
+        view.width, view.height,
+        GL_RG, GL_FLOAT,
+        m_texels.data());
+}
+
+uint64_t CpuRenderer::verify(void)
+{
+    if (!m_valid) return 0;
+
+    return verify_subdivided(
+        m_scheduler, m_engine, params(m_view),
+        m_view.width, m_view.height,
+        m_counts.data());
+}
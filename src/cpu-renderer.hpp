@@ -0,0 +1,64 @@
+#ifndef CPURENDERERH
+#define CPURENDERERH
+
+#include <stdint.h>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include "escape-time.hpp"
+#include "mariani-silver.hpp"
+#include "texture.hpp"
+#include "tile-scheduler.hpp"
+#include "view.hpp"
+
+
+// iterates a View on the cpu by Mariani-Silver subdivision, in double
+// precision, and uploads the counts for a Colorizer
+//
+// counts are exact integers, so the smooth count is the escape count
+class CpuRenderer
+{
+public:
+    CpuRenderer(void);
+
+public:
+    // render the whole frame again if the view changed
+    void update(const View& view);
+
+    // force a full redraw on the next update
+    void invalidate(void) { m_valid = false; }
+
+    // the cardioid/bulb and periodicity early-outs, what the shaders do at
+    // InteriorTest::Periodicity; the cpu has no derivative test
+    bool interior_checks(void) const { return m_interior_checks; }
+    void set_interior_checks(bool enabled);
+
+    // pixels iterated and filled by the last render
+    const SubdivisionStats& stats(void) const { return m_stats; }
+
+    // brute-force the last rendered view, and count pixels that differ
+    uint64_t verify(void);
+
+    const Texture& iterations(void) const { return m_texture; }
+
+private:
+    // view's params, with the interior checks set here
+    FractalParams params(const View& view) const;
+
+private:
+    TileScheduler m_scheduler;
+    EscapeTime m_engine;
+
+    View m_view;
+    bool m_valid = false;
+    bool m_interior_checks = true;
+    SubdivisionStats m_stats;
+
+    std::vector<uint32_t> m_counts;
+    std::vector<float> m_texels;
+    Texture m_texture;
+};
+
+#endif // CPURENDERERH
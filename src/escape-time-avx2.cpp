@@ -0,0 +1,144 @@
+#include "escape-time-kernels.hpp"
+
+#include <immintrin.h>
+
+
+// built with -mavx2 -mfma, only called after detect_simd_level()
+
+namespace {
+constexpr int LANES = 4;  // doubles per __m256d
+constexpr int GROUP = 2;  // vectors interleaved per lane group, hides fma latency
+
+// in_cardioid_or_bulb() for four lanes
+__m256d cardioid_or_bulb(__m256d x, __m256d y)
+{
+    const __m256d xq = _mm256_sub_pd(x, _mm256_set1_pd(0.25));
+    const __m256d sqy = _mm256_mul_pd(y, y);
+    const __m256d q = _mm256_fmadd_pd(xq, xq, sqy);
+    const __m256d cardioid = _mm256_cmp_pd(
+        _mm256_mul_pd(q, _mm256_add_pd(q, xq)),
+        _mm256_mul_pd(_mm256_set1_pd(0.25), sqy), _CMP_LE_OQ);
+    const __m256d xb = _mm256_add_pd(x, _mm256_set1_pd(1.0));
+    const __m256d bulb = _mm256_cmp_pd(
+        _mm256_fmadd_pd(xb, xb, sqy), _mm256_set1_pd(0.0625), _CMP_LE_OQ);
+    return _mm256_or_pd(cardioid, bulb);
+}
+}
+
+void escape_row_avx2(const FractalParams& params, int expon, const EscapeRow& row)
+{
+    const __m256d sqthresh = _mm256_set1_pd(params.threshhold * params.threshhold);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d two = _mm256_set1_pd(2.0);
+    const __m256d lane_idx = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    const __m256d originx = _mm256_set1_pd(row.originx);
+    const __m256d originy = _mm256_set1_pd(row.originy);
+    const __m256d stepx = _mm256_set1_pd(row.stepx);
+    const __m256d stepy = _mm256_set1_pd(row.stepy);
+    const __m256d dirx = _mm256_set1_pd(row.dirx);
+    const __m256d diry = _mm256_set1_pd(row.diry);
+    const __m256d max_steps = _mm256_set1_pd(params.max_steps);
+    const __m256d count_end = _mm256_set1_pd(row.count);
+    const __m256d sqeps = _mm256_set1_pd(period_epsilon(row) * period_epsilon(row));
+    const bool cardioid = params.interior_checks && expon == 2 && params.threshhold >= 2.0;
+
+    for (int px = 0; px < row.count; px += LANES*GROUP)
+    {
+        // done: lanes proven interior, they stop and count max_steps
+        __m256d cx[GROUP], cy[GROUP], zx[GROUP], zy[GROUP], count[GROUP], done[GROUP];
+        __m256d savedx[GROUP], savedy[GROUP];
+        for (int g = 0; g < GROUP; g++)
+        {
+            // frame position of each lane, exact in double
+            const __m256d pos = _mm256_add_pd(_mm256_set1_pd(px + g*LANES), lane_idx);
+            const __m256d fx = _mm256_fmadd_pd(pos, dirx, _mm256_set1_pd(row.firstx + 0.5));
+            const __m256d fy = _mm256_fmadd_pd(pos, diry, _mm256_set1_pd(row.firsty + 0.5));
+            cx[g] = _mm256_add_pd(originx, _mm256_mul_pd(fx, stepx));
+            cy[g] = _mm256_add_pd(originy, _mm256_mul_pd(fy, stepy));
+            zx[g] = cx[g];
+            zy[g] = cy[g];
+            count[g] = _mm256_setzero_pd();
+            done[g] = cardioid? cardioid_or_bulb(cx[g], cy[g]) : _mm256_setzero_pd();
+            // lanes past the end of the row are never stored, do not iterate them
+            done[g] = _mm256_or_pd(done[g], _mm256_cmp_pd(pos, count_end, _CMP_GE_OQ));
+            savedx[g] = zx[g];
+            savedy[g] = zy[g];
+        }
+
+        // brent periodicity, lanes step in lockstep so they share a window
+        uint32_t window = 1, age = 0;
+
+        for (uint32_t i = 0; i < params.max_steps; i++)
+        {
+            __m256d active[GROUP];
+            int any = 0;
+            for (int g = 0; g < GROUP; g++)
+            {
+                const __m256d sqlen = _mm256_fmadd_pd(zx[g], zx[g], _mm256_mul_pd(zy[g], zy[g]));
+                active[g] = _mm256_andnot_pd(done[g], _mm256_cmp_pd(sqlen, sqthresh, _CMP_LT_OQ));
+                any |= _mm256_movemask_pd(active[g]);
+            }
+            if (!any) break;
+
+            for (int g = 0; g < GROUP; g++)
+            {
+                __m256d nx, ny;
+                if (expon == 2)
+                {
+                    nx = _mm256_fmsub_pd(zx[g], zx[g], _mm256_mul_pd(zy[g], zy[g]));
+                    ny = _mm256_mul_pd(two, _mm256_mul_pd(zx[g], zy[g]));
+                }
+                else
+                {
+                    nx = zx[g]; ny = zy[g];
+                    for (int e = 1; e < expon; e++)
+                    {
+                        const __m256d t = _mm256_fmsub_pd(nx, zx[g], _mm256_mul_pd(ny, zy[g]));
+                        ny = _mm256_fmadd_pd(nx, zy[g], _mm256_mul_pd(ny, zx[g]));
+                        nx = t;
+                    }
+                }
+                nx = _mm256_add_pd(nx, cx[g]);
+                ny = _mm256_add_pd(ny, cy[g]);
+
+                // escaped lanes keep their last z so they cannot overflow
+                zx[g] = _mm256_blendv_pd(zx[g], nx, active[g]);
+                zy[g] = _mm256_blendv_pd(zy[g], ny, active[g]);
+                count[g] = _mm256_add_pd(count[g], _mm256_and_pd(active[g], one));
+            }
+
+            if (params.interior_checks)
+            {
+                for (int g = 0; g < GROUP; g++)
+                {
+                    const __m256d dx = _mm256_sub_pd(zx[g], savedx[g]);
+                    const __m256d dy = _mm256_sub_pd(zy[g], savedy[g]);
+                    const __m256d sqdist = _mm256_fmadd_pd(dx, dx, _mm256_mul_pd(dy, dy));
+                    const __m256d sqlen = _mm256_fmadd_pd(zx[g], zx[g], _mm256_mul_pd(zy[g], zy[g]));
+                    const __m256d periodic = _mm256_and_pd(
+                        _mm256_cmp_pd(sqdist, sqeps, _CMP_LT_OQ),
+                        _mm256_cmp_pd(sqlen, sqthresh, _CMP_LT_OQ));
+                    done[g] = _mm256_or_pd(done[g], _mm256_and_pd(active[g], periodic));
+                }
+                if (++age == window)
+                {
+                    for (int g = 0; g < GROUP; g++)
+                    {
+                        savedx[g] = zx[g];
+                        savedy[g] = zy[g];
+                    }
+                    window *= 2;
+                    age = 0;
+                }
+            }
+        }
+
+        alignas(32) double result[LANES*GROUP];
+        for (int g = 0; g < GROUP; g++)
+            _mm256_store_pd(result + g*LANES, _mm256_blendv_pd(count[g], max_steps, done[g]));
+
+        const int n = (row.count - px < LANES*GROUP)? (row.count - px) : LANES*GROUP;
+        for (int k = 0; k < n; k++)
+            row.out[(px + k) * row.out_stride] = (uint32_t)result[k];
+    }
+}
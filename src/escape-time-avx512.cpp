@@ -0,0 +1,142 @@
+#include "escape-time-kernels.hpp"
+
+#include <immintrin.h>
+
+
+// built with -mavx512f -mfma, only called after detect_simd_level()
+
+namespace {
+constexpr int LANES = 8;  // doubles per __m512d
+constexpr int GROUP = 2;  // vectors interleaved per lane group, hides fma latency
+
+// in_cardioid_or_bulb() for eight lanes
+__mmask8 cardioid_or_bulb(__m512d x, __m512d y)
+{
+    const __m512d xq = _mm512_sub_pd(x, _mm512_set1_pd(0.25));
+    const __m512d sqy = _mm512_mul_pd(y, y);
+    const __m512d q = _mm512_fmadd_pd(xq, xq, sqy);
+    const __mmask8 cardioid = _mm512_cmp_pd_mask(
+        _mm512_mul_pd(q, _mm512_add_pd(q, xq)),
+        _mm512_mul_pd(_mm512_set1_pd(0.25), sqy), _CMP_LE_OQ);
+    const __m512d xb = _mm512_add_pd(x, _mm512_set1_pd(1.0));
+    const __mmask8 bulb = _mm512_cmp_pd_mask(
+        _mm512_fmadd_pd(xb, xb, sqy), _mm512_set1_pd(0.0625), _CMP_LE_OQ);
+    return cardioid | bulb;
+}
+}
+
+void escape_row_avx512(const FractalParams& params, int expon, const EscapeRow& row)
+{
+    const __m512d sqthresh = _mm512_set1_pd(params.threshhold * params.threshhold);
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d two = _mm512_set1_pd(2.0);
+    const __m512d lane_idx = _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+    const __m512d originx = _mm512_set1_pd(row.originx);
+    const __m512d originy = _mm512_set1_pd(row.originy);
+    const __m512d stepx = _mm512_set1_pd(row.stepx);
+    const __m512d stepy = _mm512_set1_pd(row.stepy);
+    const __m512d dirx = _mm512_set1_pd(row.dirx);
+    const __m512d diry = _mm512_set1_pd(row.diry);
+    const __m512d max_steps = _mm512_set1_pd(params.max_steps);
+    const __m512d count_end = _mm512_set1_pd(row.count);
+    const __m512d sqeps = _mm512_set1_pd(period_epsilon(row) * period_epsilon(row));
+    const bool cardioid = params.interior_checks && expon == 2 && params.threshhold >= 2.0;
+
+    for (int px = 0; px < row.count; px += LANES*GROUP)
+    {
+        // done: lanes proven interior, they stop and count max_steps
+        __m512d cx[GROUP], cy[GROUP], zx[GROUP], zy[GROUP], count[GROUP];
+        __m512d savedx[GROUP], savedy[GROUP];
+        __mmask8 done[GROUP];
+        for (int g = 0; g < GROUP; g++)
+        {
+            // frame position of each lane, exact in double
+            const __m512d pos = _mm512_add_pd(_mm512_set1_pd(px + g*LANES), lane_idx);
+            const __m512d fx = _mm512_fmadd_pd(pos, dirx, _mm512_set1_pd(row.firstx + 0.5));
+            const __m512d fy = _mm512_fmadd_pd(pos, diry, _mm512_set1_pd(row.firsty + 0.5));
+            cx[g] = _mm512_add_pd(originx, _mm512_mul_pd(fx, stepx));
+            cy[g] = _mm512_add_pd(originy, _mm512_mul_pd(fy, stepy));
+            zx[g] = cx[g];
+            zy[g] = cy[g];
+            count[g] = _mm512_setzero_pd();
+            done[g] = cardioid? cardioid_or_bulb(cx[g], cy[g]) : 0;
+            // lanes past the end of the row are never stored, do not iterate them
+            done[g] |= _mm512_cmp_pd_mask(pos, count_end, _CMP_GE_OQ);
+            savedx[g] = zx[g];
+            savedy[g] = zy[g];
+        }
+
+        // brent periodicity, lanes step in lockstep so they share a window
+        uint32_t window = 1, age = 0;
+
+        for (uint32_t i = 0; i < params.max_steps; i++)
+        {
+            __mmask8 active[GROUP];
+            __mmask8 any = 0;
+            for (int g = 0; g < GROUP; g++)
+            {
+                const __m512d sqlen = _mm512_fmadd_pd(zx[g], zx[g], _mm512_mul_pd(zy[g], zy[g]));
+                active[g] = _mm512_cmp_pd_mask(sqlen, sqthresh, _CMP_LT_OQ) & ~done[g];
+                any |= active[g];
+            }
+            if (!any) break;
+
+            for (int g = 0; g < GROUP; g++)
+            {
+                __m512d nx, ny;
+                if (expon == 2)
+                {
+                    nx = _mm512_fmsub_pd(zx[g], zx[g], _mm512_mul_pd(zy[g], zy[g]));
+                    ny = _mm512_mul_pd(two, _mm512_mul_pd(zx[g], zy[g]));
+                }
+                else
+                {
+                    nx = zx[g]; ny = zy[g];
+                    for (int e = 1; e < expon; e++)
+                    {
+                        const __m512d t = _mm512_fmsub_pd(nx, zx[g], _mm512_mul_pd(ny, zy[g]));
+                        ny = _mm512_fmadd_pd(nx, zy[g], _mm512_mul_pd(ny, zx[g]));
+                        nx = t;
+                    }
+                }
+
+                // escaped lanes keep their last z so they cannot overflow
+                zx[g] = _mm512_mask_add_pd(zx[g], active[g], nx, cx[g]);
+                zy[g] = _mm512_mask_add_pd(zy[g], active[g], ny, cy[g]);
+                count[g] = _mm512_mask_add_pd(count[g], active[g], count[g], one);
+            }
+
+            if (params.interior_checks)
+            {
+                for (int g = 0; g < GROUP; g++)
+                {
+                    const __m512d dx = _mm512_sub_pd(zx[g], savedx[g]);
+                    const __m512d dy = _mm512_sub_pd(zy[g], savedy[g]);
+                    const __m512d sqdist = _mm512_fmadd_pd(dx, dx, _mm512_mul_pd(dy, dy));
+                    const __m512d sqlen = _mm512_fmadd_pd(zx[g], zx[g], _mm512_mul_pd(zy[g], zy[g]));
+                    done[g] |= active[g]
+                        & _mm512_cmp_pd_mask(sqdist, sqeps, _CMP_LT_OQ)
+                        & _mm512_cmp_pd_mask(sqlen, sqthresh, _CMP_LT_OQ);
+                }
+                if (++age == window)
+                {
+                    for (int g = 0; g < GROUP; g++)
+                    {
+                        savedx[g] = zx[g];
+                        savedy[g] = zy[g];
+                    }
+                    window *= 2;
+                    age = 0;
+                }
+            }
+        }
+
+        alignas(64) double result[LANES*GROUP];
+        for (int g = 0; g < GROUP; g++)
+            _mm512_store_pd(result + g*LANES, _mm512_mask_blend_pd(done[g], count[g], max_steps));
+
+        const int n = (row.count - px < LANES*GROUP)? (row.count - px) : LANES*GROUP;
+        for (int k = 0; k < n; k++)
+            row.out[(px + k) * row.out_stride] = (uint32_t)result[k];
+    }
+}
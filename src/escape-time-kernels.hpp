@@ -0,0 +1,57 @@
+#ifndef ESCAPETIMEKERNELSH
+#define ESCAPETIMEKERNELSH
+
+// internal to the escape-time engine, each kernel lives in its own
+// translation unit so it can be built with its own instruction set flags
+
+#include <stdint.h>
+
+#include "escape-time.hpp"
+
+
+// one row of pixels sharing an imaginary coordinate, or one column sharing
+// a real coordinate
+//
+// pixel px sits at frame position (fx, fy) = (firstx, firsty) + px * (dirx, diry),
+// at originx + (fx + 0.5) * stepx, originy + (fy + 0.5) * stepy, computed the
+// same way by every kernel so results do not depend on how a frame is tiled
+// or whether it is walked by rows or columns
+struct EscapeRow
+{
+    double originx = 0.0; // real coordinate of the frame's left edge
+    double originy = 0.0; // imaginary coordinate of the frame's bottom edge
+    double stepx = 0.0;   // real distance between pixels
+    double stepy = 0.0;   // imaginary distance between pixels
+    int firstx = 0;       // frame column of the first pixel
+    int firsty = 0;       // frame row of the first pixel
+    int dirx = 1, diry = 0; // (1, 0) along a row, (0, 1) up a column
+    int count = 0;
+    uint32_t* out = nullptr;
+    size_t out_stride = 1;  // elements between the outputs of neighbouring pixels
+};
+
+// c inside the main cardioid or the period-2 bulb of z^2 + c, whose orbits
+// stay within |z| <= 2 and so never escape a threshhold of 2 or more
+inline bool in_cardioid_or_bulb(double x, double y)
+{
+    const double xq = x - 0.25;
+    const double q = xq*xq + y*y;
+    if (q * (q + xq) <= 0.25 * y*y) return true;
+    return (x + 1.0)*(x + 1.0) + y*y <= 0.0625;
+}
+
+// an orbit coming back this close to an earlier point is taken as periodic,
+// an eighth of a pixel
+inline double period_epsilon(const EscapeRow& row)
+{
+    return 0.125 * row.stepx;
+}
+
+// any exponent
+void escape_row_scalar(const FractalParams& params, const EscapeRow& row);
+
+// integer exponents only, see integer_exponent()
+void escape_row_avx2(const FractalParams& params, int expon, const EscapeRow& row);
+void escape_row_avx512(const FractalParams& params, int expon, const EscapeRow& row);
+
+#endif // ESCAPETIMEKERNELSH
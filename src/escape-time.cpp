@@ -0,0 +1,210 @@
+#include "escape-time.hpp"
+#include "escape-time-kernels.hpp"
+
+#include <cmath>
+
+
+const char* simd_level_name(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::AVX2:   return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+SimdLevel detect_simd_level(void)
+{
+#ifdef MANDELBROT_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return SimdLevel::AVX2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+
+int integer_exponent(double exponent)
+{
+    // the [] keys step the exponent by 0.005, so allow some drift
+    const double rounded = std::round(exponent);
+    if (std::abs(exponent - rounded) > 1e-9) return 0;
+    if (rounded < 1.0 || rounded > 64.0) return 0;
+    return (int)rounded;
+}
+
+
+// scalar kernel, a line-by-line port of mandelbrot.frag
+void escape_row_scalar(const FractalParams& params, const EscapeRow& row)
+{
+    const double sqthresh = params.threshhold * params.threshhold;
+    const int expon = integer_exponent(params.exponent);
+    const bool cardioid = params.interior_checks && expon == 2 && params.threshhold >= 2.0;
+    const double sqeps = period_epsilon(row) * period_epsilon(row);
+
+    for (int px = 0; px < row.count; px++)
+    {
+        const double cx = row.originx + (row.firstx + px*row.dirx + 0.5) * row.stepx;
+        const double cy = row.originy + (row.firsty + px*row.diry + 0.5) * row.stepy;
+        uint32_t& out = row.out[px * row.out_stride];
+
+        if (cardioid && in_cardioid_or_bulb(cx, cy))
+        {
+            out = params.max_steps;
+            continue;
+        }
+
+        // brent: compare against a saved point, saved again after windows
+        // of doubling length, so any cycle is eventually caught
+        double savedx = cx, savedy = cy;
+        uint32_t window = 1, age = 0;
+
+        uint32_t i = 0;
+        double zx = cx, zy = cy;
+        while (zx*zx + zy*zy < sqthresh && i < params.max_steps)
+        {
+            if (expon == 2)
+            {
+                const double t = zx*zx - zy*zy;
+                zy = 2.0*zx*zy;
+                zx = t;
+            }
+            else if (expon != 0)
+            {
+                // z^n by repeated multiplication
+                const double bx = zx, by = zy;
+                for (int e = 1; e < expon; e++)
+                {
+                    const double t = zx*bx - zy*by;
+                    zy = zx*by + zy*bx;
+                    zx = t;
+                }
+            }
+            else
+            {
+                // compl_pow: polar form for fractional exponents
+                const double r = std::sqrt(zx*zx + zy*zy);
+                const double theta = std::atan2(zy, zx);
+                const double powr = std::pow(r, params.exponent);
+                zx = powr * std::cos(params.exponent * theta);
+                zy = powr * std::sin(params.exponent * theta);
+            }
+
+            zx += cx;
+            zy += cy;
+            i++;
+
+            if (params.interior_checks)
+            {
+                const double dx = zx - savedx, dy = zy - savedy;
+                if (dx*dx + dy*dy < sqeps && zx*zx + zy*zy < sqthresh)
+                {
+                    i = params.max_steps;
+                    break;
+                }
+                if (++age == window)
+                {
+                    savedx = zx;
+                    savedy = zy;
+                    window *= 2;
+                    age = 0;
+                }
+            }
+        }
+
+        out = i;
+    }
+}
+
+
+EscapeTime::EscapeTime(SimdLevel level) :
+    m_level(level)
+{
+    // never use a kernel the cpu cannot run
+    if (m_level > detect_simd_level())
+        m_level = detect_simd_level();
+}
+
+void EscapeTime::render(
+    const FractalParams& params,
+    int width, int height,
+    uint32_t* out) const
+{
+    render_rect(params, width, height, 0, 0, width, height, out, width);
+}
+
+void EscapeTime::render_rect(
+    const FractalParams& params,
+    int width, int height,
+    int x, int y, int w, int h,
+    uint32_t* out, size_t out_stride) const
+{
+    if (width <= 0 || height <= 0) return;
+
+    // same mapping as mandelbrot.vert + mandelbrot.frag:
+    //   f_st = pixel center in [-1,1]
+    //   st = vec2(aspect, 1) * f_st / zoom + center
+    const double stepx = 2.0 / width * params.aspect / params.zoom;
+    const double stepy = 2.0 / height / params.zoom;
+    const double originx = params.centerx - params.aspect / params.zoom;
+    const double originy = params.centery - 1.0 / params.zoom;
+
+    const int expon = integer_exponent(params.exponent);
+
+    // walk tall, narrow rectangles by columns, so the vector kernels'
+    // lanes are not mostly past the end of each line
+    const bool columns = h > w;
+    const int lines = columns? w : h;
+
+    for (int line = 0; line < lines; line++)
+    {
+        EscapeRow r;
+        r.originx = originx;
+        r.originy = originy;
+        r.stepx = stepx;
+        r.stepy = stepy;
+        if (columns)
+        {
+            r.firstx = x + line;
+            r.firsty = y;
+            r.dirx = 0;
+            r.diry = 1;
+            r.count = h;
+            r.out = out + line;
+            r.out_stride = out_stride;
+        }
+        else
+        {
+            r.firstx = x;
+            r.firsty = y + line;
+            r.count = w;
+            r.out = out + line * out_stride;
+        }
+
+        // vector kernels only handle z^n for integer n
+        if (expon == 0)
+        {
+            escape_row_scalar(params, r);
+            continue;
+        }
+
+        switch (m_level)
+        {
+#ifdef MANDELBROT_X86_KERNELS
+            case SimdLevel::AVX512:
+                escape_row_avx512(params, expon, r);
+                break;
+            case SimdLevel::AVX2:
+                escape_row_avx2(params, expon, r);
+                break;
+#endif
+            default:
+                escape_row_scalar(params, r);
+                break;
+        }
+    }
+}
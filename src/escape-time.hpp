@@ -0,0 +1,74 @@
+#ifndef ESCAPETIMEH
+#define ESCAPETIMEH
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+// the same parameters mandelbrot.frag takes as uniforms
+struct FractalParams
+{
+    double centerx = 0.0, centery = 0.0;
+    double zoom = 0.4;
+    double aspect = 1.0;
+
+    double exponent = 2.0;
+    double threshhold = 2.0;
+
+    uint32_t max_steps = 1024;
+
+    // end interior pixels early: cardioid/bulb test for z^2 + c, and
+    // periodicity checking for any exponent
+    bool interior_checks = true;
+};
+
+
+enum class SimdLevel : uint8_t
+{
+    Scalar, // one pixel at a time, any exponent
+    AVX2,   // 8 pixels per lane group (2x __m256d)
+    AVX512, // 16 pixels per lane group (2x __m512d)
+};
+
+const char* simd_level_name(SimdLevel level);
+
+// integer exponent, or 0 if the exponent is fractional (or out of range)
+// and needs the polar form
+int integer_exponent(double exponent);
+
+// best level supported by both this build and the running cpu
+SimdLevel detect_simd_level(void);
+
+
+// CPU escape-time iteration, mirroring shaders/mandelbrot.frag
+//
+// output buffers hold the iteration count per pixel, in [0, max_steps], and
+// use the same layout as a GL texture (row 0 is the bottom of the frame)
+class EscapeTime
+{
+public:
+    EscapeTime(void) : EscapeTime(detect_simd_level()) {}
+    explicit EscapeTime(SimdLevel level);
+
+public:
+    SimdLevel level(void) const { return m_level; }
+
+    // iterate a whole width*height frame into out (tightly packed)
+    void render(
+        const FractalParams& params,
+        int width, int height,
+        uint32_t* out) const;
+
+    // iterate the sub-rectangle [x, x+w) * [y, y+h) of a width*height frame
+    // into out, whose rows are out_stride elements apart
+    void render_rect(
+        const FractalParams& params,
+        int width, int height,
+        int x, int y, int w, int h,
+        uint32_t* out, size_t out_stride) const;
+
+private:
+    SimdLevel m_level = SimdLevel::Scalar;
+};
+
+#endif // ESCAPETIMEH
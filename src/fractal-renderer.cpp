@@ -0,0 +1,566 @@
+#include "fractal-renderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "escape-time.hpp"
+#include "gl-state.hpp"
+
+
+namespace {
+
+static const float s_quad_vertices[] =
+{
+    // position
+    -1.0f,  1.0f,
+    -1.0f, -1.0f,
+     1.0f, -1.0f,
+
+    -1.0f,  1.0f,
+     1.0f, -1.0f,
+     1.0f,  1.0f
+};
+
+// reference orbit is stored row-major in a 2D texture of this width
+constexpr static int ORBIT_TEXTURE_WIDTH = 1024;
+
+// BLA entries take two RGBA32F texels, (A, B) then (log2 r, 0, 0, 0), and
+// are stored the same way; levels past perturbation.frag's array size would
+// skip more steps than any sensible max_steps anyway
+constexpr static int BLA_TEXTURE_WIDTH = 1024;
+constexpr static int BLA_MAX_LEVELS = 24;
+
+// relative error allowed per skipped step, about float's precision
+constexpr static double BLA_EPSILON = 0x1p-24;
+
+// the compute path's tiles are one workgroup, 64 invocations like a wave on
+// most gpus, and as persistent threads this many workgroups are kept
+// running, enough to fill any gpu
+constexpr static int COMPUTE_TILE_SIZE = 8;
+constexpr static GLuint COMPUTE_GROUPS = 256;
+
+
+// integer exponents get an unrolled kernel, 0 means the polar path
+static ShaderDefines program_defines(int expon, InteriorTest test)
+{
+    ShaderDefines defines;
+    if (expon != 0)
+        defines["EXPONENT"] = std::to_string(expon);
+    if (test != InteriorTest::Off)
+        defines["INTERIOR_CHECKS"] = "1";
+    if (test == InteriorTest::Derivative)
+        defines["DERIVATIVE_TEST"] = "1";
+    return defines;
+}
+
+// squared distance an orbit must come back within to count as periodic,
+// an eighth of a pixel like the cpu kernels
+static float period_sqeps(const View& view)
+{
+    const double eps = 0.125 * 2.0 / (view.zoom * view.height);
+    return (float)(eps * eps);
+}
+
+// split a double into the (hi, lo) float pair of a df64 uniform
+static void set_df64_uniform(GLint location, double value)
+{
+    const float hi = (float)value;
+    const float lo = (float)(value - hi);
+    glUniform2f(location, hi, lo);
+}
+
+} // anonymous namespace
+
+
+const char* fractal_mode_name(FractalMode mode)
+{
+    switch (mode)
+    {
+        case FractalMode::Float:        return "float";
+        case FractalMode::DoubleFloat:  return "df64";
+        case FractalMode::Perturbation: return "perturbation";
+    }
+    return "unknown";
+}
+
+const char* interior_test_name(InteriorTest test)
+{
+    switch (test)
+    {
+        case InteriorTest::Off:         return "off";
+        case InteriorTest::Periodicity: return "periodicity";
+        case InteriorTest::Derivative:  return "derivative";
+    }
+    return "unknown";
+}
+
+
+FractalRenderer::FractalRenderer(void) :
+    m_orbit_texture(GL_RG32F),
+    m_bla_texture(GL_RGBA32F)
+{
+    // fullscreen quad shared by every fractal program
+    m_vao.add_vertex_buffer(2*sizeof(float), 0);
+    auto& vbo = m_vao.get_buffer(0);
+    vbo.add_attrib(2, GL_FLOAT); // vec2 v_position
+    vbo.bind_data((void*)s_quad_vertices, 6, GL_STATIC_DRAW);
+
+    // build the default view's variants up front, and the deep zoom one;
+    // none is used yet, so they compile side by side
+    m_df64_supported = GLEW_ARB_gpu_shader5;
+    float_program(2);
+    if (m_df64_supported)
+        double_float_program(2);
+    perturbation_program(false);
+    perturbation_program(true);
+
+    m_compute_supported = GLEW_VERSION_4_3;
+    if (m_compute_supported)
+    {
+        // llvmpipe ends any loop nest after 65535 iterations, which a
+        // workgroup that keeps taking tiles soon runs into
+        const char* renderer = (const char*)glGetString(GL_RENDERER);
+        m_compute_persistent = !renderer || !strstr(renderer, "llvmpipe");
+
+        glGenBuffers(1, &m_tile_queue);
+        glGenBuffers(1, &m_tile_costs);
+    }
+
+    // both are read with texelFetch, and must not need mipmaps
+    for (const Texture* tex : {&m_orbit_texture, &m_bla_texture})
+    {
+        tex->use();
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+}
+
+FractalRenderer::~FractalRenderer(void)
+{
+    if (m_tile_costs_fence)
+        glDeleteSync(m_tile_costs_fence);
+    glDeleteBuffers(1, &m_tile_queue);
+    glDeleteBuffers(1, &m_tile_costs);
+}
+
+
+FractalMode FractalRenderer::mode_for(const View& view) const
+{
+    // fractional exponents need the polar form, which only the float
+    // shader has, and perturbation is only derived for z^2 + c
+    const int expon = integer_exponent(view.exponent);
+    if (view.zoom <= FLOAT_ZOOM_LIMIT || expon == 0)
+        return FractalMode::Float;
+    if (expon == 2 && (view.zoom > DOUBLE_FLOAT_ZOOM_LIMIT || !m_df64_supported))
+        return FractalMode::Perturbation;
+    if (m_df64_supported)
+        return FractalMode::DoubleFloat;
+    return FractalMode::Float;
+}
+
+void FractalRenderer::draw(const View& view)
+{
+    // every pixel is overwritten, whatever the HUD left enabled
+    GLState::current().set_enabled(GL_DEPTH_TEST, false);
+    GLState::current().set_enabled(GL_BLEND, false);
+
+    switch (mode_for(view))
+    {
+        case FractalMode::Float:
+            draw_float(view);
+            break;
+        case FractalMode::DoubleFloat:
+            draw_double_float(view);
+            break;
+        case FractalMode::Perturbation:
+            draw_perturbation(view);
+            break;
+    }
+
+    m_vao.use();
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+
+const Program& FractalRenderer::float_program(int expon)
+{
+    return m_programs.get(
+        std::filesystem::path{"shaders/mandelbrot.vert"},
+        std::filesystem::path{"shaders/mandelbrot.frag"},
+        program_defines(expon, m_interior_test));
+}
+
+const Program& FractalRenderer::double_float_program(int expon)
+{
+    return m_programs.get(
+        std::filesystem::path{"shaders/mandelbrot.vert"},
+        std::filesystem::path{"shaders/mandelbrot-df64.frag"},
+        program_defines(expon, m_interior_test));
+}
+
+const Program& FractalRenderer::perturbation_program(bool exp_map)
+{
+    ShaderDefines defines;
+    if (exp_map)
+        defines["EXP_MAP"] = "1";
+    return m_programs.get(
+        std::filesystem::path{"shaders/mandelbrot.vert"},
+        std::filesystem::path{"shaders/perturbation.frag"},
+        defines);
+}
+
+const Program& FractalRenderer::compute_program(int expon)
+{
+    ShaderDefines defines = program_defines(expon, m_interior_test);
+    defines["TILE_SIZE"] = std::to_string(COMPUTE_TILE_SIZE);
+    defines["PERSISTENT"] = m_compute_persistent? "1" : "0";
+    return m_programs.get_compute(
+        std::filesystem::path{"shaders/mandelbrot.comp"},
+        defines);
+}
+
+
+const FractalRenderer::FloatUniforms& FractalRenderer::float_uniforms(
+    const Program& prog, int expon, bool compute)
+{
+    auto [it, added] = m_float_uniforms.try_emplace(&prog);
+    FloatUniforms& unif = it->second;
+    if (!added) return unif;
+
+    // a variant's defines are fixed, so what it was built for decides
+    // which uniforms it has
+    unif.aspect = prog.get_uniform("aspect");
+    unif.max_steps = prog.get_uniform("max_steps");
+    unif.thresh = prog.get_uniform("thresh");
+    unif.center = prog.get_uniform("center");
+    unif.zoom = prog.get_uniform("zoom");
+    unif.view_size = prog.get_uniform("view_size");
+    if (m_interior_test != InteriorTest::Off)
+        unif.period_sqeps = prog.get_uniform("period_sqeps");
+    if (expon == 0)
+        unif.expon = prog.get_uniform("expon");
+    if (compute)
+    {
+        unif.tiles_x = prog.get_uniform("tiles_x");
+        unif.tile_count = prog.get_uniform("tile_count");
+    }
+    return unif;
+}
+
+const FractalRenderer::DoubleFloatUniforms& FractalRenderer::double_float_uniforms(const Program& prog)
+{
+    auto [it, added] = m_double_float_uniforms.try_emplace(&prog);
+    DoubleFloatUniforms& unif = it->second;
+    if (!added) return unif;
+
+    unif.aspect = prog.get_uniform("aspect");
+    unif.max_steps = prog.get_uniform("max_steps");
+    unif.thresh = prog.get_uniform("thresh");
+    unif.center_x = prog.get_uniform("center_x");
+    unif.center_y = prog.get_uniform("center_y");
+    unif.inv_zoom = prog.get_uniform("inv_zoom");
+    if (m_interior_test != InteriorTest::Off)
+        unif.period_sqeps = prog.get_uniform("period_sqeps");
+    return unif;
+}
+
+const FractalRenderer::PerturbationUniforms& FractalRenderer::perturbation_uniforms(
+    const Program& prog, bool exp_map)
+{
+    auto [it, added] = m_perturbation_uniforms.try_emplace(&prog);
+    PerturbationUniforms& unif = it->second;
+    if (!added) return unif;
+
+    unif.orbit = prog.get_uniform("orbit");
+    unif.orbit_len = prog.get_uniform("orbit_len");
+    unif.orbit_width = prog.get_uniform("orbit_width");
+    unif.max_steps = prog.get_uniform("max_steps");
+    unif.thresh = prog.get_uniform("thresh");
+    unif.dc_scale = prog.get_uniform("dc_scale");
+    unif.dc_exp = prog.get_uniform("dc_exp");
+    unif.use_bla = prog.get_uniform("use_bla");
+    unif.bla = prog.get_uniform("bla");
+    unif.bla_width = prog.get_uniform("bla_width");
+    unif.bla_levels = prog.get_uniform("bla_levels");
+    unif.bla_offsets = prog.get_uniform("bla_offsets");
+    unif.bla_sizes = prog.get_uniform("bla_sizes");
+    if (exp_map)
+        unif.log_height = prog.get_uniform("log_height");
+    else
+        unif.aspect = prog.get_uniform("aspect");
+    return unif;
+}
+
+
+void FractalRenderer::draw_float(const View& view)
+{
+    use_float(float_program(integer_exponent(view.exponent)), view, false);
+}
+
+const FractalRenderer::FloatUniforms& FractalRenderer::use_float(
+    const Program& prog, const View& view, bool compute)
+{
+    const FloatUniforms& unif = float_uniforms(prog, integer_exponent(view.exponent), compute);
+
+    prog.use();
+    glUniform1f(unif.aspect, view.aspect());
+    glUniform1ui(unif.max_steps, view.max_steps);
+    glUniform1f(unif.thresh, view.threshhold);
+    glUniform2f(unif.center, view.centerx.to_double(), view.centery.to_double());
+    glUniform1f(unif.zoom, view.zoom);
+    glUniform2f(unif.view_size, (float)view.width, (float)view.height);
+    if (unif.period_sqeps != -1)
+        glUniform1f(unif.period_sqeps, period_sqeps(view));
+    if (unif.expon != -1)
+        glUniform1f(unif.expon, view.exponent);
+    return unif;
+}
+
+void FractalRenderer::draw_compute(const View& view, Texture& target)
+{
+    const int tiles_x = (view.width + COMPUTE_TILE_SIZE - 1) / COMPUTE_TILE_SIZE;
+    const int tiles_y = (view.height + COMPUTE_TILE_SIZE - 1) / COMPUTE_TILE_SIZE;
+    const GLuint tile_count = (GLuint)(tiles_x * tiles_y);
+    update_tile_order(tiles_x, tiles_y);
+
+    // the counter starts over every draw, the order is only uploaded when
+    // it changed
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_tile_queue);
+    if (m_tile_order_changed)
+    {
+        glBufferData(GL_SHADER_STORAGE_BUFFER, (tile_count + 1) * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(uint32_t), tile_count * sizeof(uint32_t), m_tile_order.data());
+        m_tile_order_changed = false;
+    }
+    const uint32_t next_tile = 0;
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(next_tile), &next_tile);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_tile_queue);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_tile_costs);
+    glBindImageTexture(0, target.id(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32F);
+
+    const FloatUniforms& unif = use_float(compute_program(integer_exponent(view.exponent)), view, true);
+    glUniform1ui(unif.tiles_x, (GLuint)tiles_x);
+    glUniform1ui(unif.tile_count, tile_count);
+
+    glDispatchCompute(m_compute_persistent? std::min(tile_count, COMPUTE_GROUPS) : tile_count, 1, 1);
+
+    // target is sampled (colorizing) or read through a framebuffer next,
+    // and the costs are read back with glGetBufferSubData
+    glMemoryBarrier(
+        GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT
+        | GL_PIXEL_BUFFER_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    if (m_tile_costs_fence)
+        glDeleteSync(m_tile_costs_fence);
+    m_tile_costs_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void FractalRenderer::update_tile_order(int tiles_x, int tiles_y)
+{
+    const std::size_t tile_count = (std::size_t)tiles_x * tiles_y;
+
+    // costs for another grid say nothing about this one
+    if (tiles_x != m_tiles_x || tiles_y != m_tiles_y)
+    {
+        m_tiles_x = tiles_x;
+        m_tiles_y = tiles_y;
+        m_tile_order.resize(tile_count);
+        std::iota(m_tile_order.begin(), m_tile_order.end(), 0u);
+        m_tile_order_changed = true;
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_tile_costs);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, tile_count * sizeof(uint32_t), nullptr, GL_DYNAMIC_READ);
+        if (m_tile_costs_fence)
+            glDeleteSync(m_tile_costs_fence);
+        m_tile_costs_fence = nullptr;
+        return;
+    }
+
+    if (!m_tile_ordering)
+    {
+        if (!std::is_sorted(m_tile_order.begin(), m_tile_order.end()))
+        {
+            std::iota(m_tile_order.begin(), m_tile_order.end(), 0u);
+            m_tile_order_changed = true;
+        }
+        return;
+    }
+
+    // never stall on the gpu for an estimate, the order it has will do
+    if (!m_tile_costs_fence) return;
+    const GLenum status = glClientWaitSync(m_tile_costs_fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return;
+    glDeleteSync(m_tile_costs_fence);
+    m_tile_costs_fence = nullptr;
+
+    m_tile_cost_values.resize(tile_count);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_tile_costs);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, tile_count * sizeof(uint32_t), m_tile_cost_values.data());
+
+    // longest first, so the tiles taken last are short and no workgroup
+    // runs long after the others are done
+    std::iota(m_tile_order.begin(), m_tile_order.end(), 0u);
+    std::stable_sort(m_tile_order.begin(), m_tile_order.end(), [&](uint32_t a, uint32_t b)
+    {
+        return m_tile_cost_values[a] > m_tile_cost_values[b];
+    });
+    m_tile_order_changed = true;
+}
+
+void FractalRenderer::draw_double_float(const View& view)
+{
+    // only picked for integer exponents
+    const Program& prog = double_float_program(integer_exponent(view.exponent));
+    const DoubleFloatUniforms& unif = double_float_uniforms(prog);
+
+    prog.use();
+    glUniform1f(unif.aspect, view.aspect());
+    glUniform1ui(unif.max_steps, view.max_steps);
+    glUniform1f(unif.thresh, view.threshhold);
+    set_df64_uniform(unif.center_x, view.centerx.to_double());
+    set_df64_uniform(unif.center_y, view.centery.to_double());
+    set_df64_uniform(unif.inv_zoom, 1.0 / view.zoom);
+    if (unif.period_sqeps != -1)
+        glUniform1f(unif.period_sqeps, period_sqeps(view));
+}
+
+void FractalRenderer::draw_perturbation(const View& view)
+{
+    // largest |dc| is at the frame's corners
+    const Program& prog = perturbation_program(false);
+    const PerturbationUniforms& unif = perturbation_uniforms(prog, false);
+    use_perturbation(prog, unif, view, 1.0 / view.zoom, std::hypot(view.aspect(), 1.0) / view.zoom);
+    glUniform1f(unif.aspect, view.aspect());
+}
+
+void FractalRenderer::draw_exp_map(const View& view, double outer, double log_height)
+{
+    GLState::current().set_enabled(GL_DEPTH_TEST, false);
+    GLState::current().set_enabled(GL_BLEND, false);
+
+    // the table only has to be rebuilt when the radius halves, bands in
+    // between reuse the one for the next power of 2 out
+    const Program& prog = perturbation_program(true);
+    const PerturbationUniforms& unif = perturbation_uniforms(prog, true);
+    use_perturbation(prog, unif, view, outer, std::ldexp(1.0, std::ilogb(outer) + 1));
+    glUniform1f(unif.log_height, log_height);
+
+    m_vao.use();
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+void FractalRenderer::use_perturbation(
+    const Program& prog, const PerturbationUniforms& unif,
+    const View& view, double dc, double dc_max)
+{
+    update_orbit(view);
+    if (m_bla_enabled)
+        update_bla(dc_max);
+
+    // split dc into a float-sized mantissa and an exponent
+    int dc_exp = 0;
+    const double dc_scale = std::frexp(dc, &dc_exp);
+
+    prog.use();
+    glUniform1i(unif.orbit_len, (GLint)m_orbit.size());
+    glUniform1i(unif.orbit_width, ORBIT_TEXTURE_WIDTH);
+    glUniform1ui(unif.max_steps, view.max_steps);
+    glUniform1f(unif.dc_scale, dc_scale);
+    glUniform1i(unif.dc_exp, dc_exp);
+    glUniform1f(unif.thresh, view.threshhold);
+    glUniform1i(unif.use_bla, m_bla_enabled);
+
+    // orbit sampler reads from slot 0, bla from slot 1
+    glUniform1i(unif.orbit, 0);
+    glUniform1i(unif.bla, 1);
+    GLState::current().active_texture(0);
+    m_orbit_texture.use();
+
+    if (m_bla_enabled)
+    {
+        GLint offsets[BLA_MAX_LEVELS] = {0}, sizes[BLA_MAX_LEVELS] = {0};
+        const int levels = std::min((int)m_bla.level_count(), BLA_MAX_LEVELS);
+        for (int l = 0; l < levels; l++)
+        {
+            offsets[l] = (GLint)m_bla.level_offset(l);
+            sizes[l] = (GLint)m_bla.level_size(l);
+        }
+        glUniform1i(unif.bla_width, BLA_TEXTURE_WIDTH);
+        glUniform1i(unif.bla_levels, levels);
+        glUniform1iv(unif.bla_offsets, BLA_MAX_LEVELS, offsets);
+        glUniform1iv(unif.bla_sizes, BLA_MAX_LEVELS, sizes);
+
+        GLState::current().active_texture(1);
+        m_bla_texture.use();
+        GLState::current().active_texture(0);
+    }
+}
+
+void FractalRenderer::update_orbit(const View& view)
+{
+    const int precision = reference_precision(view.zoom, view.height);
+
+    // a reference computed at higher precision is still good
+    if (precision <= m_orbit_precision
+        && view.centerx == m_orbit_cx && view.centery == m_orbit_cy
+        && bits_equal(view.threshhold, m_orbit_threshhold)
+        && view.max_steps == m_orbit_max_steps)
+        return;
+
+    m_orbit.compute(view.centerx, view.centery, precision, view.threshhold, view.max_steps);
+    m_orbit_cx = view.centerx;
+    m_orbit_cy = view.centery;
+    m_orbit_precision = precision;
+    m_orbit_threshhold = view.threshhold;
+    m_orbit_max_steps = view.max_steps;
+    m_orbit_changed = true;
+
+    // upload as whole rows of RG32F texels
+    const int rows = ((int)m_orbit.size() + ORBIT_TEXTURE_WIDTH - 1) / ORBIT_TEXTURE_WIDTH;
+    std::vector<float> texels((std::size_t)rows * ORBIT_TEXTURE_WIDTH * 2, 0.0f);
+    for (std::size_t n = 0; n < m_orbit.size(); n++)
+    {
+        texels[2*n + 0] = (float)m_orbit.x(n);
+        texels[2*n + 1] = (float)m_orbit.y(n);
+    }
+    m_orbit_texture.set_pixels(
+        ORBIT_TEXTURE_WIDTH, rows,
+        GL_RG, GL_FLOAT,
+        texels.data());
+}
+
+void FractalRenderer::update_bla(double dc_max)
+{
+    if (!m_orbit_changed && bits_equal(dc_max, m_bla_dc_max))
+        return;
+
+    m_bla.build(m_orbit, dc_max, BLA_EPSILON);
+    m_bla_dc_max = dc_max;
+    m_orbit_changed = false;
+
+    // upload as whole rows of RGBA32F texels, radii as log2 since they
+    // are as far out of float range as the deltas they are compared to
+    const std::vector<BlaEntry>& entries = m_bla.entries();
+    const std::size_t texel_count = std::max<std::size_t>(2 * entries.size(), 1);
+    const int rows = (int)((texel_count + BLA_TEXTURE_WIDTH - 1) / BLA_TEXTURE_WIDTH);
+    std::vector<float> texels((std::size_t)rows * BLA_TEXTURE_WIDTH * 4, 0.0f);
+    for (std::size_t j = 0; j < entries.size(); j++)
+    {
+        const BlaEntry& e = entries[j];
+        float* t = &texels[8*j];
+        t[0] = (float)e.ax;
+        t[1] = (float)e.ay;
+        t[2] = (float)e.bx;
+        t[3] = (float)e.by;
+        t[4] = (e.r > 0.0)? (float)std::log2(e.r) : -1e30f;
+    }
+    m_bla_texture.set_pixels(
+        BLA_TEXTURE_WIDTH, rows,
+        GL_RGBA, GL_FLOAT,
+        texels.data());
+}
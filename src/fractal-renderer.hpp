@@ -0,0 +1,204 @@
+#ifndef FRACTALRENDERERH
+#define FRACTALRENDERERH
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include "bigfixed.hpp"
+#include "bla-table.hpp"
+#include "program.hpp"
+#include "program-cache.hpp"
+#include "reference-orbit.hpp"
+#include "texture.hpp"
+#include "vertex-array.hpp"
+#include "view.hpp"
+
+
+enum class FractalMode : uint8_t
+{
+    Float,        // mandelbrot.frag, single precision coordinates
+    DoubleFloat,  // mandelbrot-df64.frag, emulated double precision
+    Perturbation, // perturbation.frag, deltas around a cpu reference orbit
+};
+
+const char* fractal_mode_name(FractalMode mode);
+
+// early-outs for pixels inside the set, each level includes the one before
+enum class InteriorTest : uint8_t
+{
+    Off,
+    Periodicity, // cardioid/bulb test for z^2 + c, and brent periodicity checking
+    Derivative,  // an attracting orbit test on dz/dz0, integer exponents only
+};
+
+const char* interior_test_name(InteriorTest test);
+
+
+// draws the fractal for a View into the bound RenderTarget, picking the
+// cheapest shader that still has enough precision for the zoom
+//
+// the target should be GL_RG32F: every program writes the escape count and
+// the smooth escape count, which a Colorizer turns into colors
+class FractalRenderer
+{
+public:
+    // float coordinates stop resolving single pixels around here
+    constexpr static double FLOAT_ZOOM_LIMIT = 1e5;
+    // and df64 coordinates (48 bits) around here
+    constexpr static double DOUBLE_FLOAT_ZOOM_LIMIT = 1e10;
+
+    FractalRenderer(void);
+    ~FractalRenderer(void);
+
+    FractalRenderer(const FractalRenderer&) = delete;
+    FractalRenderer& operator=(const FractalRenderer&) = delete;
+
+public:
+    FractalMode mode_for(const View& view) const;
+
+    // bilinear approximation lets deep perturbation renders skip runs of
+    // iterations, it can be turned off to compare timings
+    bool bla_enabled(void) const { return m_bla_enabled; }
+    void set_bla_enabled(bool enabled) { m_bla_enabled = enabled; }
+
+    // float and df64 shaders only, perturbation iterates deltas that do not
+    // settle into the reference's cycle
+    InteriorTest interior_test(void) const { return m_interior_test; }
+    void set_interior_test(InteriorTest test) { m_interior_test = test; }
+
+    // the bound RenderTarget should be view.width x view.height
+    void draw(const View& view);
+
+    // the compute path needs gl 4.3 (compute shaders, storage buffers and
+    // image stores); contexts ask for 3.3 core, most drivers give more
+    bool compute_supported(void) const { return m_compute_supported; }
+
+    // the float path from a compute shader into target, which must be
+    // GL_RG32F and view.width x view.height, with the same output as draw()
+    // gives in FractalMode::Float. pixels within a tile diverge like they do
+    // in a fragment quad, but expensive tiles no longer hold up cheap ones
+    void draw_compute(const View& view, Texture& target);
+
+    // hand the compute path's tiles out most expensive first, by their escape
+    // counts in the last draw, instead of in rows
+    bool tile_ordering(void) const { return m_tile_ordering; }
+    void set_tile_ordering(bool enabled) { m_tile_ordering = enabled; }
+
+    // draw part of an exponential map around view's center into the bound
+    // RenderTarget, by perturbation (so exponent 2 only): x goes once around
+    // the center, and y from radius outer at the bottom in by a factor of
+    // e^log_height at the top. view only supplies the center, escape
+    // parameters, and the deepest zoom (for the reference's precision)
+    void draw_exp_map(const View& view, double outer, double log_height);
+
+private:
+    // variant for an integer exponent, or the polar path for 0, and the
+    // current interior test
+    const Program& float_program(int expon);
+    const Program& double_float_program(int expon);
+    // plain, or the exponential map variant
+    const Program& perturbation_program(bool exp_map);
+    const Program& compute_program(int expon);
+
+    // uniform locations of a variant, looked up on its first use; only the
+    // ones the variant's defines leave in are found, the rest stay -1
+    struct FloatUniforms
+    {
+        GLint aspect = -1, max_steps = -1, thresh = -1;
+        GLint center = -1, zoom = -1, view_size = -1;
+        GLint period_sqeps = -1, expon = -1;
+        GLint tiles_x = -1, tile_count = -1; // compute only
+    };
+    struct DoubleFloatUniforms
+    {
+        GLint aspect = -1, max_steps = -1, thresh = -1;
+        GLint center_x = -1, center_y = -1, inv_zoom = -1;
+        GLint period_sqeps = -1;
+    };
+    struct PerturbationUniforms
+    {
+        GLint orbit = -1, orbit_len = -1, orbit_width = -1;
+        GLint max_steps = -1, thresh = -1, dc_scale = -1, dc_exp = -1;
+        GLint use_bla = -1, bla = -1, bla_width = -1, bla_levels = -1;
+        GLint bla_offsets = -1, bla_sizes = -1;
+        GLint aspect = -1;     // plain only
+        GLint log_height = -1; // exponential map only
+    };
+
+    const FloatUniforms& float_uniforms(const Program& prog, int expon, bool compute);
+    const DoubleFloatUniforms& double_float_uniforms(const Program& prog);
+    const PerturbationUniforms& perturbation_uniforms(const Program& prog, bool exp_map);
+
+    // bind prog, either float program (fragment or compute), with view's
+    // uniforms
+    const FloatUniforms& use_float(const Program& prog, const View& view, bool compute);
+
+    void draw_float(const View& view);
+    void draw_double_float(const View& view);
+    void draw_perturbation(const View& view);
+
+    // bind a perturbation program for view's reference, with pixel deltas
+    // scaled by dc and BLA valid up to |dc| = dc_max
+    void use_perturbation(
+        const Program& prog, const PerturbationUniforms& unif,
+        const View& view, double dc, double dc_max);
+
+    // reorder the compute path's tiles by the last draw's costs, if they
+    // are back without waiting, or start over for a new tile grid
+    void update_tile_order(int tiles_x, int tiles_y);
+
+    // recompute and upload the reference orbit if the view needs a new one
+    void update_orbit(const View& view);
+    // rebuild and upload the BLA table if the orbit or the largest delta changed
+    void update_bla(double dc_max);
+
+private:
+    VertexArray m_vao;
+
+    // float and df64 programs, specialized per integer exponent, and the
+    // perturbation programs
+    ProgramCache m_programs;
+    // by variant, which m_programs keeps for as long as it lives
+    std::unordered_map<const Program*, FloatUniforms> m_float_uniforms;
+    std::unordered_map<const Program*, DoubleFloatUniforms> m_double_float_uniforms;
+    std::unordered_map<const Program*, PerturbationUniforms> m_perturbation_uniforms;
+
+    // df64 needs `precise` (ARB_gpu_shader5) to survive the shader compiler
+    bool m_df64_supported = false;
+
+    InteriorTest m_interior_test = InteriorTest::Periodicity;
+
+    bool m_compute_supported = false;
+    // workgroups keep taking tiles, or there is one per tile
+    bool m_compute_persistent = true;
+    bool m_tile_ordering = true;
+    // the compute path's tile queue (a counter, then m_tile_order) and
+    // escape counts per tile, as shader storage buffers
+    GLuint m_tile_queue = 0, m_tile_costs = 0;
+    int m_tiles_x = 0, m_tiles_y = 0;
+    std::vector<uint32_t> m_tile_order, m_tile_cost_values;
+    bool m_tile_order_changed = false;
+    // signaled once the last draw's tile costs are written
+    GLsync m_tile_costs_fence = nullptr;
+
+    ReferenceOrbit m_orbit;
+    Texture m_orbit_texture;
+    // what m_orbit was computed for
+    BigFixed m_orbit_cx, m_orbit_cy;
+    int m_orbit_precision = -1;
+    double m_orbit_threshhold = 0.0;
+    uint32_t m_orbit_max_steps = 0;
+    bool m_orbit_changed = false;
+
+    bool m_bla_enabled = true;
+    BlaTable m_bla;
+    Texture m_bla_texture;
+    // what m_bla was built for
+    double m_bla_dc_max = 0.0;
+};
+
+#endif // FRACTALRENDERERH
@@ -0,0 +1,238 @@
+#include "frame-capture.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <signal.h>
+#include <vector>
+
+#include "gl-state.hpp"
+
+
+FrameCapture::~FrameCapture(void)
+{
+    stop();
+}
+
+
+bool FrameCapture::start(const std::string& path, int width, int height)
+{
+    stop();
+
+    if (path == "-")
+        mp_file = stdout;
+    else
+        mp_file = fopen(path.c_str(), "wb");
+    if (mp_file == nullptr)
+    {
+        std::cerr << "capture: could not open " << path << std::endl;
+        return false;
+    }
+
+#ifdef SIGPIPE
+    // an encoder that quits early should end the capture, not the program
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    m_width = width;
+    m_height = height;
+    const GLsizeiptr size = (GLsizeiptr)width * height * 4;
+    for (Slot& slot : m_slots)
+    {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        slot.state = SlotState::Free;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_oldest = m_next = 0;
+    m_written = 0;
+    m_dropped = 0;
+    m_capture_ms = 0.0;
+    m_stop = false;
+    m_write_failed = false;
+    m_writer = std::thread(&FrameCapture::writer_main, this);
+    return true;
+}
+
+void FrameCapture::stop(void)
+{
+    if (!active()) return;
+
+    // hand over every read, then let the writer drain its queue
+    collect(true);
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_writer.join();
+    collect(false);
+
+    for (Slot& slot : m_slots)
+    {
+        glDeleteBuffers(1, &slot.pbo);
+        slot = Slot{};
+    }
+
+    if (mp_file == stdout)
+        fflush(mp_file);
+    else
+        fclose(mp_file);
+    mp_file = nullptr;
+
+    std::cerr << "capture: " << m_written << " frames written, "
+        << m_dropped << " of them repeats standing in for dropped ones" << std::endl;
+}
+
+
+void FrameCapture::capture(RenderTarget& target)
+{
+    if (!active()) return;
+    const auto start = std::chrono::steady_clock::now();
+
+    if (target.width() != m_width || target.height() != m_height)
+    {
+        std::cerr << "capture: frame size changed, stopping" << std::endl;
+        stop();
+        return;
+    }
+    if (m_write_failed)
+    {
+        std::cerr << "capture: could not write, stopping" << std::endl;
+        stop();
+        return;
+    }
+
+    collect(false);
+
+    // every buffer is busy, the gpu or the writer is behind: repeat the last
+    // frame instead, after it if it is still being read, or else now
+    Slot& slot = m_slots[m_next];
+    if (slot.state != SlotState::Free)
+    {
+        m_dropped++;
+        Slot& last = m_slots[(m_next + SLOT_COUNT - 1) % SLOT_COUNT];
+        if (last.state == SlotState::Reading)
+            last.repeats++;
+        else
+        {
+            {
+                std::lock_guard lock(m_mutex);
+                m_queue.push_back(REPEAT);
+            }
+            m_cv.notify_one();
+        }
+        return;
+    }
+
+    // into the buffer, glReadPixels returns without waiting for the copy;
+    // RGBA is the format drivers copy without converting, the writer drops
+    // the alpha
+    GLState::current().bind_framebuffer(GL_READ_FRAMEBUFFER, target.fbo());
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.state = SlotState::Reading;
+    m_next = (m_next + 1) % SLOT_COUNT;
+
+    const double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    m_capture_ms = (m_capture_ms > 0.0)? 0.9 * m_capture_ms + 0.1 * ms : ms;
+}
+
+
+void FrameCapture::collect(bool wait)
+{
+    std::deque<int> done;
+    {
+        std::lock_guard lock(m_mutex);
+        done.swap(m_done);
+    }
+    for (int idx : done)
+    {
+        Slot& slot = m_slots[idx];
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        slot.pixels = nullptr;
+        slot.state = SlotState::Free;
+    }
+
+    const GLsizeiptr size = (GLsizeiptr)m_width * m_height * 4;
+    while (m_slots[m_oldest].state == SlotState::Reading)
+    {
+        Slot& slot = m_slots[m_oldest];
+        const GLuint64 timeout = wait? 1000000000ull : 0;
+        const GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            if (wait && status == GL_TIMEOUT_EXPIRED) continue;
+            break;
+        }
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        slot.pixels = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+        slot.state = SlotState::Writing;
+        {
+            std::lock_guard lock(m_mutex);
+            m_queue.push_back(m_oldest);
+            m_queue.insert(m_queue.end(), slot.repeats, REPEAT);
+        }
+        slot.repeats = 0;
+        m_cv.notify_one();
+
+        m_oldest = (m_oldest + 1) % SLOT_COUNT;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void FrameCapture::writer_main(void)
+{
+    // the last frame written, kept for REPEAT
+    std::vector<uint8_t> frame((std::size_t)m_width * m_height * 3);
+    bool have_frame = false;
+    while (true)
+    {
+        int idx = -1;
+        {
+            std::unique_lock lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) return;
+            idx = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        if (idx != REPEAT)
+        {
+            // GL rows are bottom-up, video rows top-down
+            const uint8_t* pixels = m_slots[idx].pixels;
+            have_frame = pixels != nullptr;
+            for (int y = 0; have_frame && y < m_height; y++)
+            {
+                const uint8_t* src = pixels + (std::size_t)(m_height - 1 - y) * m_width * 4;
+                uint8_t* dst = frame.data() + (std::size_t)y * m_width * 3;
+                for (int x = 0; x < m_width; x++)
+                {
+                    dst[3*x + 0] = src[4*x + 0];
+                    dst[3*x + 1] = src[4*x + 1];
+                    dst[3*x + 2] = src[4*x + 2];
+                }
+            }
+        }
+
+        const bool ok = have_frame && !m_write_failed
+            && fwrite(frame.data(), 1, frame.size(), mp_file) == frame.size();
+        if (ok) m_written++;
+        else m_write_failed = true;
+
+        if (idx == REPEAT) continue;
+        std::lock_guard lock(m_mutex);
+        m_done.push_back(idx);
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef FRAMECAPTUREH
+#define FRAMECAPTUREH
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include "rendertarget.hpp"
+
+
+// records frames of a RenderTarget as raw RGB24, top row first, to a file
+// or to stdout for an encoder:
+//   mandelbrot --capture - | ffmpeg -f rawvideo -pix_fmt rgb24 -s 1280x720 -r 60 -i - out.mp4
+//
+// nothing waits on the gpu: each frame is read into a pixel buffer object
+// with a fence, and picked up a few frames later once the fence has passed.
+// the mapped buffer goes straight to a writer thread, so the main loop only
+// pays for issuing the copy. a frame is dropped (and counted) instead of
+// stalling when every buffer is still busy, with the gpu or the writer; the
+// one before it is written again in its place, so the output keeps one frame
+// per capture() and a constant frame rate
+class FrameCapture
+{
+public:
+    // buffers in flight, about the frames of latency
+    constexpr static int SLOT_COUNT = 4;
+
+    FrameCapture(void) = default;
+    ~FrameCapture(void);
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+public:
+    // start writing width x height frames to path, "-" for stdout; false
+    // (after printing why) if it cannot be opened
+    bool start(const std::string& path, int width, int height);
+    // write out every frame still in flight, and close the output
+    void stop(void);
+    bool active(void) const { return mp_file != nullptr; }
+
+    // queue target's current contents, once per frame; a target of another
+    // size than start()'s ends the capture, raw video has one frame size
+    void capture(RenderTarget& target);
+
+    // frames written so far, counting the repeats that stand in for
+    // dropped ones
+    uint64_t frames_written(void) const { return m_written.load(); }
+    uint64_t frames_dropped(void) const { return m_dropped; }
+    // smoothed cpu time of capture(), in milliseconds
+    double capture_ms(void) const { return m_capture_ms; }
+
+private:
+    // only the main (GL) thread changes a slot's state
+    enum class SlotState : uint8_t
+    {
+        Free,
+        Reading, // copy issued, fence pending
+        Writing, // mapped, queued for or owned by the writer
+    };
+
+    struct Slot
+    {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        SlotState state = SlotState::Free;
+        const uint8_t* pixels = nullptr;
+        // frames dropped right after this one, to write it again for
+        int repeats = 0;
+    };
+
+    // in the writer's queue: write the last frame again
+    constexpr static int REPEAT = -1;
+
+    // unmap slots the writer is done with, and hand it finished reads in
+    // frame order; wait blocks on the gpu instead of leaving unfinished
+    // reads for later
+    void collect(bool wait);
+
+    void writer_main(void);
+
+private:
+    Slot m_slots[SLOT_COUNT];
+    // oldest read not yet handed to the writer, and the next slot to read into
+    int m_oldest = 0, m_next = 0;
+
+    int m_width = 0, m_height = 0;
+    FILE* mp_file = nullptr;
+
+    std::atomic<uint64_t> m_written = 0;
+    uint64_t m_dropped = 0;
+    double m_capture_ms = 0.0;
+
+    // slots (or REPEAT) for the writer, in frame order, and slots it is
+    // done with
+    std::thread m_writer;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<int> m_queue, m_done;
+    bool m_stop = false;
+    std::atomic<bool> m_write_failed = false;
+};
+
+#endif // FRAMECAPTUREH
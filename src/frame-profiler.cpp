@@ -0,0 +1,156 @@
+#include "frame-profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+void TimingStats::add(double ms)
+{
+    m_samples[m_count % WINDOW] = ms;
+    m_count++;
+}
+
+double TimingStats::last(void) const
+{
+    return m_count? m_samples[(m_count - 1) % WINDOW] : 0.0;
+}
+
+double TimingStats::average(void) const
+{
+    const size_t n = size();
+    if (n == 0) return 0.0;
+
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+        sum += m_samples[i];
+    return sum / n;
+}
+
+double TimingStats::p99(void) const
+{
+    const size_t n = size();
+    if (n == 0) return 0.0;
+
+    // nearest rank, which is the max until the window holds 100 samples
+    double sorted[WINDOW];
+    std::copy(m_samples, m_samples + n, sorted);
+    const size_t rank = (size_t)std::ceil(0.99 * n) - 1;
+    std::nth_element(sorted, sorted + rank, sorted + n);
+    return sorted[rank];
+}
+
+double TimingStats::max(void) const
+{
+    const size_t n = size();
+    if (n == 0) return 0.0;
+    return *std::max_element(m_samples, m_samples + n);
+}
+
+
+GpuTimer::GpuTimer(void)
+{
+    glGenQueries(QUERY_COUNT, m_queries);
+}
+
+GpuTimer::~GpuTimer(void)
+{
+    glDeleteQueries(QUERY_COUNT, m_queries);
+}
+
+
+void GpuTimer::begin(uint64_t frame)
+{
+    if (frame == m_dropped_frame) return;
+
+    // every query is still pending, give up on timing this frame
+    if (m_in_flight == QUERY_COUNT)
+    {
+        m_dropped_frame = frame;
+        return;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, m_queries[m_next]);
+    m_frames[m_next] = frame;
+    m_running = true;
+}
+
+void GpuTimer::end(void)
+{
+    if (!m_running) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    m_next = (m_next + 1) % QUERY_COUNT;
+    m_in_flight++;
+    m_running = false;
+}
+
+void GpuTimer::collect(TimingStats& stats)
+{
+    // oldest first, stop at the first one the gpu has not finished
+    while (m_in_flight > 0)
+    {
+        const int idx = (m_next - m_in_flight + QUERY_COUNT) % QUERY_COUNT;
+        GLint available = 0;
+        glGetQueryObjectiv(m_queries[idx], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(m_queries[idx], GL_QUERY_RESULT, &ns);
+        m_in_flight--;
+
+        // a later frame's result means the summed one is complete
+        if (m_frames[idx] != m_sum_frame)
+        {
+            if (m_sum_frame != UINT64_MAX && m_sum_frame != m_dropped_frame)
+                stats.add(m_sum_ms);
+            m_sum_frame = m_frames[idx];
+            m_sum_ms = 0.0;
+        }
+        m_sum_ms += ns * 1e-6;
+    }
+}
+
+
+int FrameProfiler::add_pass(const char* name)
+{
+    m_passes.push_back(std::make_unique<Pass>());
+    m_passes.back()->name = name;
+    return (int)m_passes.size() - 1;
+}
+
+void FrameProfiler::begin_frame(void)
+{
+    for (auto& pass : m_passes)
+        pass->timer.collect(pass->gpu);
+
+    m_frame++;
+    m_frame_start = Clock::now();
+}
+
+void FrameProfiler::end_frame(void)
+{
+    for (auto& pass : m_passes)
+    {
+        if (pass->ran)
+            pass->cpu.add(pass->cpu_ms);
+        pass->cpu_ms = 0.0;
+        pass->ran = false;
+    }
+
+    m_frame_stats.add(std::chrono::duration<double, std::milli>(
+        Clock::now() - m_frame_start).count());
+}
+
+void FrameProfiler::begin(int pass)
+{
+    Pass& p = *m_passes[pass];
+    p.timer.begin(m_frame);
+    p.start = Clock::now();
+}
+
+void FrameProfiler::end(int pass)
+{
+    Pass& p = *m_passes[pass];
+    p.cpu_ms += std::chrono::duration<double, std::milli>(Clock::now() - p.start).count();
+    p.ran = true;
+    p.timer.end();
+}
@@ -0,0 +1,156 @@
+#ifndef FRAMEPROFILERH
+#define FRAMEPROFILERH
+
+#include <stddef.h>
+#include <stdint.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+
+// the last WINDOW samples of a timing, in milliseconds
+class TimingStats
+{
+public:
+    constexpr static size_t WINDOW = 128;
+
+    void add(double ms);
+
+    // samples ever added, to tell when a new one arrived
+    uint64_t count(void) const { return m_count; }
+    double last(void) const;
+
+    // over the window; 0 before the first sample
+    double average(void) const;
+    double p99(void) const;
+    double max(void) const;
+
+private:
+    size_t size(void) const { return (m_count < WINDOW)? (size_t)m_count : WINDOW; }
+
+    double m_samples[WINDOW] = {0.0};
+    uint64_t m_count = 0;
+};
+
+
+// GL_TIME_ELAPSED queries around the sections of one pass, read back a few
+// frames late so they never stall; sections of the same frame add up to one
+// sample
+class GpuTimer
+{
+public:
+    constexpr static int QUERY_COUNT = 16;
+
+    GpuTimer(void);
+    ~GpuTimer(void);
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+public:
+    // queries cannot nest, not even across timers
+    void begin(uint64_t frame);
+    void end(void);
+
+    // add every finished frame's total to stats
+    void collect(TimingStats& stats);
+
+private:
+    GLuint m_queries[QUERY_COUNT] = {0};
+    uint64_t m_frames[QUERY_COUNT] = {0};
+    int m_next = 0, m_in_flight = 0;
+    bool m_running = false;
+
+    // a frame that ran out of queries has no full total, so it is left out
+    uint64_t m_dropped_frame = UINT64_MAX;
+
+    // total of the frame being read back
+    uint64_t m_sum_frame = UINT64_MAX;
+    double m_sum_ms = 0.0;
+};
+
+
+// cpu and gpu time of each named pass of a frame, always on: a pass costs
+// two timer queries and two clock reads per section
+//
+//     const int pass = profiler.add_pass("fractal");
+//     ...
+//     profiler.begin_frame();
+//     { ScopedPass scope(profiler, pass); draw(); }
+//     profiler.end_frame();
+//
+// passes must not overlap, since their timer queries cannot nest
+class FrameProfiler
+{
+public:
+    FrameProfiler(void) = default;
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+public:
+    // name must outlive the profiler; returns the pass's index
+    int add_pass(const char* name);
+
+    // collect finished gpu timings, without waiting, and start the frame's
+    // cpu clock; end_frame() closes the frame's cpu timings
+    void begin_frame(void);
+    void end_frame(void);
+
+    // a pass may run several times in a frame, its times add up
+    void begin(int pass);
+    void end(int pass);
+
+    size_t pass_count(void) const { return m_passes.size(); }
+    const char* name(int pass) const { return m_passes[pass]->name; }
+    const TimingStats& gpu(int pass) const { return m_passes[pass]->gpu; }
+    const TimingStats& cpu(int pass) const { return m_passes[pass]->cpu; }
+
+    // cpu time from begin_frame() to end_frame()
+    const TimingStats& frame(void) const { return m_frame_stats; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pass
+    {
+        const char* name = "";
+        GpuTimer timer;
+        TimingStats gpu, cpu;
+
+        Clock::time_point start;
+        double cpu_ms = 0.0; // this frame's sections so far
+        bool ran = false;
+    };
+
+    std::vector<std::unique_ptr<Pass>> m_passes;
+
+    uint64_t m_frame = 0;
+    Clock::time_point m_frame_start;
+    TimingStats m_frame_stats;
+};
+
+
+// times a pass until the end of the scope
+class ScopedPass
+{
+public:
+    ScopedPass(FrameProfiler& profiler, int pass) :
+        m_profiler(profiler), m_pass(pass)
+    {
+        m_profiler.begin(m_pass);
+    }
+    ~ScopedPass(void) { m_profiler.end(m_pass); }
+
+    ScopedPass(const ScopedPass&) = delete;
+    ScopedPass& operator=(const ScopedPass&) = delete;
+
+private:
+    FrameProfiler& m_profiler;
+    int m_pass;
+};
+
+#endif // FRAMEPROFILERH
@@ -0,0 +1,145 @@
+#include "gl-state.hpp"
+
+
+GLState& GLState::current(void)
+{
+    static GLState s_state;
+    return s_state;
+}
+
+
+void GLState::use_program(GLuint program)
+{
+    if (!changed(program != m_program)) return;
+    glUseProgram(program);
+    m_program = program;
+}
+
+void GLState::bind_vertex_array(GLuint vao)
+{
+    if (!changed(vao != m_vao)) return;
+    glBindVertexArray(vao);
+    m_vao = vao;
+}
+
+
+void GLState::bind_framebuffer(GLenum target, GLuint fbo)
+{
+    const bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    const bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    if (!changed((draw && fbo != m_draw_fbo) || (read && fbo != m_read_fbo))) return;
+
+    glBindFramebuffer(target, fbo);
+    if (draw) m_draw_fbo = fbo;
+    if (read) m_read_fbo = fbo;
+}
+
+void GLState::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (!changed(x != m_viewport[0] || y != m_viewport[1]
+        || width != m_viewport[2] || height != m_viewport[3])) return;
+
+    glViewport(x, y, width, height);
+    m_viewport[0] = x;
+    m_viewport[1] = y;
+    m_viewport[2] = width;
+    m_viewport[3] = height;
+}
+
+
+void GLState::active_texture(int unit)
+{
+    if (!changed(unit != m_active_unit)) return;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    m_active_unit = unit;
+}
+
+void GLState::bind_texture(GLuint texture)
+{
+    const bool tracked = m_active_unit >= 0 && m_active_unit < TEXTURE_UNITS;
+    if (!changed(!tracked || texture != m_textures[m_active_unit])) return;
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (tracked) m_textures[m_active_unit] = texture;
+}
+
+
+int GLState::cap_index(GLenum cap)
+{
+    switch (cap)
+    {
+        case GL_DEPTH_TEST:   return 0;
+        case GL_BLEND:        return 1;
+        case GL_CULL_FACE:    return 2;
+        case GL_SCISSOR_TEST: return 3;
+    }
+    return -1;
+}
+
+void GLState::set_enabled(GLenum cap, bool enabled)
+{
+    const int idx = cap_index(cap);
+    if (!changed(idx < 0 || m_caps[idx] != (int8_t)enabled)) return;
+
+    if (enabled) glEnable(cap);
+    else glDisable(cap);
+    if (idx >= 0) m_caps[idx] = (int8_t)enabled;
+}
+
+void GLState::blend_func(GLenum src, GLenum dst)
+{
+    if (!changed(src != m_blend_src || dst != m_blend_dst)) return;
+    glBlendFunc(src, dst);
+    m_blend_src = src;
+    m_blend_dst = dst;
+}
+
+void GLState::polygon_mode(GLenum mode)
+{
+    if (!changed(mode != m_polygon_mode)) return;
+    glPolygonMode(GL_FRONT_AND_BACK, mode);
+    m_polygon_mode = mode;
+}
+
+
+// deleting a bound object binds 0 in its place
+void GLState::forget_program(GLuint program)
+{
+    // a program in use is only flagged for deletion, but its name may still
+    // come back once it is replaced
+    if (m_program == program) m_program = UNKNOWN;
+}
+
+void GLState::forget_vertex_array(GLuint vao)
+{
+    if (m_vao == vao) m_vao = 0;
+}
+
+void GLState::forget_framebuffer(GLuint fbo)
+{
+    if (m_draw_fbo == fbo) m_draw_fbo = 0;
+    if (m_read_fbo == fbo) m_read_fbo = 0;
+}
+
+void GLState::forget_texture(GLuint texture)
+{
+    for (GLuint& bound : m_textures)
+        if (bound == texture) bound = 0;
+}
+
+
+void GLState::invalidate(void)
+{
+    m_program = m_vao = UNKNOWN;
+    m_draw_fbo = m_read_fbo = UNKNOWN;
+    m_viewport[0] = m_viewport[1] = m_viewport[2] = m_viewport[3] = -1;
+
+    m_active_unit = -1;
+    for (GLuint& bound : m_textures)
+        bound = UNKNOWN;
+
+    for (int8_t& cap : m_caps)
+        cap = -1;
+    m_blend_src = m_blend_dst = UNKNOWN;
+    m_polygon_mode = UNKNOWN;
+}
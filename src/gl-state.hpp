@@ -0,0 +1,96 @@
+#ifndef GLSTATEH
+#define GLSTATEH
+
+#include <stdint.h>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+
+// the GL context's binding and pipeline state, as last set through here,
+// so that setting it to what it already is costs no GL call
+//
+// the wrapper classes (Program, RenderTarget, Texture, VertexArray) and the
+// passes that toggle depth, blend and the like all go through it. anything
+// unknown (at startup, or after invalidate()) is always set, so state
+// changed behind its back is only a problem until the next invalidate().
+// there is one per process: the program runs a single GL context
+class GLState
+{
+public:
+    // texture units tracked, binds on higher ones always reach GL
+    constexpr static int TEXTURE_UNITS = 32;
+
+    static GLState& current(void);
+
+    GLState(const GLState&) = delete;
+    GLState& operator=(const GLState&) = delete;
+
+public:
+    void use_program(GLuint program);
+    void bind_vertex_array(GLuint vao);
+
+    // target is GL_FRAMEBUFFER (both), GL_DRAW_FRAMEBUFFER or
+    // GL_READ_FRAMEBUFFER
+    void bind_framebuffer(GLenum target, GLuint fbo);
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    // unit is an index, GL_TEXTURE0 + unit; textures are GL_TEXTURE_2D
+    void active_texture(int unit);
+    void bind_texture(GLuint texture);
+
+    // GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE or GL_SCISSOR_TEST are tracked,
+    // other caps always reach GL
+    void set_enabled(GLenum cap, bool enabled);
+    void blend_func(GLenum src, GLenum dst);
+    // for both faces
+    void polygon_mode(GLenum mode);
+
+    // an object is being deleted, GL unbinds it and may reuse its name
+    void forget_program(GLuint program);
+    void forget_vertex_array(GLuint vao);
+    void forget_framebuffer(GLuint fbo);
+    void forget_texture(GLuint texture);
+
+    // forget everything, after GL state was changed without going through
+    // here
+    void invalidate(void);
+
+    // state changes that reached GL, and ones skipped as redundant
+    uint64_t calls(void) const { return m_calls; }
+    uint64_t skipped(void) const { return m_skipped; }
+
+private:
+    GLState(void) { invalidate(); }
+
+    // count a change, true if it has to reach GL
+    bool changed(bool differs)
+    {
+        if (differs) m_calls++;
+        else m_skipped++;
+        return differs;
+    }
+
+    // index into m_caps, or -1 if cap is not tracked
+    static int cap_index(GLenum cap);
+
+private:
+    // a name no object has, for state not known
+    constexpr static GLuint UNKNOWN = 0xffffffffu;
+
+    GLuint m_program, m_vao;
+    GLuint m_draw_fbo, m_read_fbo;
+    GLint m_viewport[4];
+
+    int m_active_unit;
+    GLuint m_textures[TEXTURE_UNITS];
+
+    // 0 or 1, or -1 if not known
+    int8_t m_caps[4];
+    GLenum m_blend_src, m_blend_dst;
+    GLenum m_polygon_mode;
+
+    uint64_t m_calls = 0, m_skipped = 0;
+};
+
+#endif // GLSTATEH
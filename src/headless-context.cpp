@@ -0,0 +1,134 @@
+#include "headless-context.hpp"
+
+#include <iostream>
+#include <string.h>
+
+#include <EGL/eglext.h>
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+
+// error checking for EGL calls
+#define checkEGLError(val) _checkEGLError( (val), #val, __FILE__, __LINE__ )
+void _checkEGLError(
+    bool const failed,
+    char const *const func,
+    const char *const file,
+    int const line)
+{
+    if (failed)
+    {
+        std::cerr << "\nEGL Error: 0x" << std::hex << eglGetError() << std::dec
+            << "\n...at " << file << ":" << line << " '" << func << "'"
+            << std::endl;
+        exit(-1);
+    }
+}
+
+
+namespace {
+
+static bool has_extension(const char* extensions, const char* name)
+{
+    if (extensions == NULL) return false;
+
+    // whole words only, one extension name can prefix another
+    const size_t len = strlen(name);
+    for (const char* p = strstr(extensions, name); p != NULL; p = strstr(p + len, name))
+        if ((p == extensions || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0'))
+            return true;
+    return false;
+}
+
+static EGLDisplay surfaceless_display(void)
+{
+    const char* client = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (!has_extension(client, "EGL_MESA_platform_surfaceless"))
+        return EGL_NO_DISPLAY;
+
+    auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+        eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display == NULL)
+        return EGL_NO_DISPLAY;
+
+    return get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+}
+
+} // anonymous namespace
+
+
+HeadlessContext::HeadlessContext(void)
+{
+    m_display = surfaceless_display();
+    const bool surfaceless = m_display != EGL_NO_DISPLAY;
+    if (!surfaceless)
+        m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    checkEGLError(m_display == EGL_NO_DISPLAY);
+
+    EGLint major = 0, minor = 0;
+    checkEGLError(!eglInitialize(m_display, &major, &minor));
+    checkEGLError(!eglBindAPI(EGL_OPENGL_API));
+
+    // only needed for the pbuffer, everything is drawn into fbos
+    const EGLint config_attribs[] =
+    {
+        EGL_SURFACE_TYPE, surfaceless? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = NULL;
+    EGLint config_count = 0;
+    checkEGLError(!eglChooseConfig(m_display, config_attribs, &config, 1, &config_count)
+        || config_count < 1);
+
+    // use opengl 3.3-core, same as Screen
+    const EGLint context_attribs[] =
+    {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, context_attribs);
+    checkEGLError(m_context == EGL_NO_CONTEXT);
+
+    if (!surfaceless)
+    {
+        const EGLint pbuffer_attribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        m_surface = eglCreatePbufferSurface(m_display, config, pbuffer_attribs);
+        checkEGLError(m_surface == EGL_NO_SURFACE);
+    }
+    checkEGLError(!eglMakeCurrent(m_display, m_surface, m_surface, m_context));
+
+    // init GLEW; builds for GLX report a missing X display once the
+    // core entry points are loaded, which is harmless here
+    glewExperimental = GL_TRUE;
+    const GLenum glew = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    if (glew != GLEW_OK && glew != GLEW_ERROR_NO_GLX_DISPLAY)
+#else
+    if (glew != GLEW_OK)
+#endif
+    {
+        std::cerr << "\nGLEW Error: " << glewGetErrorString(glew) << std::endl;
+        exit(-1);
+    }
+}
+
+HeadlessContext::~HeadlessContext(void)
+{
+    if (m_display == EGL_NO_DISPLAY) return;
+
+    eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_surface != EGL_NO_SURFACE)
+        eglDestroySurface(m_display, m_surface);
+    if (m_context != EGL_NO_CONTEXT)
+        eglDestroyContext(m_display, m_context);
+    eglTerminate(m_display);
+}
+
+
+const char* HeadlessContext::renderer(void) const
+{
+    return (const char*)glGetString(GL_RENDERER);
+}
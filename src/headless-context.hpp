@@ -0,0 +1,32 @@
+#ifndef HEADLESSCONTEXTH
+#define HEADLESSCONTEXTH
+
+#include <EGL/egl.h>
+
+
+// an OpenGL 3.3-core context without a window, for rendering into
+// RenderTargets on machines with no display
+//
+// uses a surfaceless display (EGL_MESA_platform_surfaceless, which llvmpipe
+// supports) if there is one, and otherwise the default display with a 1x1
+// pbuffer that is never drawn to
+class HeadlessContext
+{
+public:
+    HeadlessContext(void);
+    ~HeadlessContext(void);
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+public:
+    // GL_RENDERER, to tell hardware from llvmpipe
+    const char* renderer(void) const;
+
+private:
+    EGLDisplay m_display = EGL_NO_DISPLAY;
+    EGLSurface m_surface = EGL_NO_SURFACE;
+    EGLContext m_context = EGL_NO_CONTEXT;
+};
+
+#endif // HEADLESSCONTEXTH
@@ -0,0 +1,55 @@
+#include "latency-meter.hpp"
+
+
+LatencyMeter::LatencyMeter(void)
+{
+    glGenQueries(QUERY_COUNT, m_queries);
+}
+
+LatencyMeter::~LatencyMeter(void)
+{
+    glDeleteQueries(QUERY_COUNT, m_queries);
+}
+
+
+void LatencyMeter::presented(Clock::time_point key_time, uint64_t key_frame, uint64_t frame)
+{
+    if (m_in_flight == QUERY_COUNT) return;
+
+    Pending& p = m_pending[m_next];
+    p.key_time = key_time;
+    p.frames = frame - key_frame;
+
+    // the gpu clock now, against the middle of the cpu clock around reading it
+    const Clock::time_point before = Clock::now();
+    glGetInteger64v(GL_TIMESTAMP, &p.gpu_time);
+    p.cpu_time = before + (Clock::now() - before) / 2;
+
+    glQueryCounter(m_queries[m_next], GL_TIMESTAMP);
+    m_next = (m_next + 1) % QUERY_COUNT;
+    m_in_flight++;
+}
+
+void LatencyMeter::collect(void)
+{
+    // oldest first, stop at the first one the gpu has not finished
+    while (m_in_flight > 0)
+    {
+        const int idx = (m_next - m_in_flight + QUERY_COUNT) % QUERY_COUNT;
+        GLint available = 0;
+        glGetQueryObjectiv(m_queries[idx], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(m_queries[idx], GL_QUERY_RESULT, &ns);
+        m_in_flight--;
+
+        // when the frame was done, on the cpu clock
+        const Pending& p = m_pending[idx];
+        const Clock::time_point done = p.cpu_time + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::nanoseconds((GLint64)ns - p.gpu_time));
+        const double ms = std::chrono::duration<double, std::milli>(done - p.key_time).count();
+        m_ms.add((ms > 0.0)? ms : 0.0);
+        m_frames.add((double)p.frames);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef LATENCYMETERH
+#define LATENCYMETERH
+
+#include <stdint.h>
+#include <chrono>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include "frame-profiler.hpp"
+
+
+// time from a keypress to the gpu finishing the first frame that shows it,
+// in milliseconds and in frames presented in between
+//
+// a GL_TIMESTAMP query right after the frame's swap marks when the gpu got
+// through it; the gpu clock is matched to the cpu one as the query is issued,
+// so the result is read back whenever it is ready, frames later or after an
+// idle wait, and still dates the frame exactly. scanout adds up to one more
+// refresh, which no GL query sees
+class LatencyMeter
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    constexpr static int QUERY_COUNT = 8;
+
+    LatencyMeter(void);
+    ~LatencyMeter(void);
+
+    LatencyMeter(const LatencyMeter&) = delete;
+    LatencyMeter& operator=(const LatencyMeter&) = delete;
+
+public:
+    // right after the swap of the first frame showing a key pressed at
+    // key_time, when key_frame frames had been presented; frame counts this
+    // one. dropped if every query is still pending
+    void presented(Clock::time_point key_time, uint64_t key_frame, uint64_t frame);
+
+    // add every finished frame's latency, without waiting
+    void collect(void);
+
+    const TimingStats& ms(void) const { return m_ms; }
+    const TimingStats& frames(void) const { return m_frames; }
+
+private:
+    struct Pending
+    {
+        Clock::time_point key_time;
+        uint64_t frames = 0;
+        // the gpu clock, in nanoseconds, at cpu_time
+        GLint64 gpu_time = 0;
+        Clock::time_point cpu_time;
+    };
+
+    GLuint m_queries[QUERY_COUNT] = {0};
+    Pending m_pending[QUERY_COUNT];
+    int m_next = 0, m_in_flight = 0;
+
+    TimingStats m_ms, m_frames;
+};
+
+#endif // LATENCYMETERH
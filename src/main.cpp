@@ -1,7 +1,13 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string>
 #include <string_view>
+#include <thread>
 
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
@@ -11,23 +17,124 @@
 #include "texture.hpp"
 #include "text.hpp"
 #include "rendertarget.hpp"
-#include "vertex-array.hpp"
+#include "fractal-renderer.hpp"
+#include "reprojection.hpp"
+#include "tile-cache.hpp"
+#include "colorizer.hpp"
+#include "cpu-renderer.hpp"
+#include "resolution-scaler.hpp"
+#include "frame-capture.hpp"
+#include "frame-profiler.hpp"
+#include "gl-state.hpp"
+#include "latency-meter.hpp"
+#include "program.hpp"
+#include "triple-buffer.hpp"
+#include "view.hpp"
+#include "view-controls.hpp"
 
 
 
 constexpr static uint32_t MAX_DEPTH = 1024;
 
-const float quad_vertices[] =
+// a zoom preview is iterated back in over this many frames
+constexpr static size_t PREVIEW_FRAMES = 4;
+
+// gpu time for iterating the fractal each frame while moving, leaves room
+// in a 60Hz frame for everything else
+constexpr static double FRAME_BUDGET_MS = 10.0;
+
+// memory for cached fractal tiles
+constexpr static size_t TILE_CACHE_BYTES = 256u << 20;
+
+// linked programs are kept here between runs, next to shaders/
+constexpr static const char* SHADER_CACHE_DIR = "shader-cache";
+
+// held keys are sampled this often, whatever the frame rate
+constexpr static int INPUT_INTERVAL_MS = 4;
+
+// a key just pressed moves the view this far at once, one 60Hz frame's
+// worth, so a tap always does something
+constexpr static double FIRST_STEP_S = 1.0 / 60.0;
+
+// longest step between two samples, in case the input thread was held up
+constexpr static double MAX_STEP_S = 0.1;
+
+
+using Clock = std::chrono::steady_clock;
+
+// keys that flip something in the render thread
+enum class Action : uint8_t
 {
-    // position
-    -1.0f,  1.0f,
-    -1.0f, -1.0f,
-     1.0f, -1.0f,
-
-    -1.0f,  1.0f,
-     1.0f, -1.0f,
-     1.0f,  1.0f
+    Bla,       // B
+    Smooth,    // C
+    Interior,  // I
+    Cpu,       // M
+    Verify,    // V
+    Profile,   // P
+    Capture,   // F
+    None,
 };
+constexpr static int ACTION_COUNT = (int)Action::None;
+
+static Action action_for(SDL_Keycode key)
+{
+    switch (key)
+    {
+        case SDLK_b: return Action::Bla;
+        case SDLK_c: return Action::Smooth;
+        case SDLK_i: return Action::Interior;
+        case SDLK_m: return Action::Cpu;
+        case SDLK_v: return Action::Verify;
+        case SDLK_p: return Action::Profile;
+        case SDLK_f: return Action::Capture;
+    }
+    return Action::None;
+}
+
+
+// what the input thread hands the render thread, as of one moment
+struct Controls
+{
+    View view;
+    // a view key is held, so newer views keep coming
+    bool moving = false;
+
+    // presses of each action so far; the render thread carries out the
+    // ones it has not seen, so presses in between two frames are not lost
+    uint32_t presses[ACTION_COUNT] = {0};
+
+    // the last keypress that changes what is shown, to time until it is;
+    // key_id 0 is none yet
+    uint64_t key_id = 0;
+    Clock::time_point key_time;
+    // frames presented when it was pressed
+    uint64_t key_frame = 0;
+};
+
+// everything the input and render threads share
+struct Shared
+{
+    explicit Shared(const Controls& initial) : controls(initial) {}
+
+    // latest controls, from the input thread
+    TripleBuffer<Controls> controls;
+    // counts writes to controls, the render thread sleeps on it when idle
+    std::atomic<uint32_t> published = 0;
+    std::atomic<bool> quit = false;
+
+    // from the render thread: frames presented, and the height the fractal
+    // is iterated at, which pans move by whole pixels of
+    std::atomic<uint64_t> frames = 0;
+    std::atomic<int> internal_height = 1;
+};
+
+// input thread: hand controls to the render thread, and wake it
+static void publish(Shared& shared, const Controls& controls)
+{
+    shared.controls.write(controls);
+    shared.published.fetch_add(1, std::memory_order_release);
+    shared.published.notify_one();
+}
 
 
 // arcane mythic runes from the opengl docs
@@ -48,177 +155,450 @@ void GLAPIENTRY MessageCallback(
     fflush(stderr);
 }
 
-int main()
+// render thread: draws the latest controls for as long as there is
+// something to draw, until the input thread quits
+static void render_loop(Screen& screen, Shared& shared, const std::string& capture_path, Clock::time_point start)
 {
-    Screen screen(1280, 720, "Mandelbrot");
-
     // enable debug output
     glEnable(GL_DEBUG_OUTPUT);
     glDebugMessageCallback(MessageCallback, 0);
 
-    // current exponent and threshhold information
-    double exponent = 2.0;
-    double threshhold = 2.0;
-
-    // current view settings
-    double centerx = 0.0, centery = 0.0;
-    double zoom = 0.4;
-
-    Program prog_mandelbrot(
-        std::filesystem::path{"shaders/mandelbrot.vert"},
-        std::filesystem::path{"shaders/mandelbrot.frag"});
-    prog_mandelbrot.use();
-
-    // only need to set aspect and max depth once up-front
-    glUniform1f(
-        prog_mandelbrot.get_uniform("aspect"),
-        (float)screen.width() / screen.height());
-    glUniform1ui(
-        prog_mandelbrot.get_uniform("max_steps"),
-        MAX_DEPTH);
-
-    GLint unif_exponent   = prog_mandelbrot.get_uniform("expon");
-    GLint unif_threshhold = prog_mandelbrot.get_uniform("thresh");
-    GLint unif_center     = prog_mandelbrot.get_uniform("center");
-    GLint unif_zoom       = prog_mandelbrot.get_uniform("zoom");
-
-    // for rendering mandelbrot program
-    VertexArray vao_mandelbrot;
-    vao_mandelbrot.add_vertex_buffer(2*sizeof(float), 0);
-    // upload quad
-    auto& vbo = vao_mandelbrot.get_buffer(0);
-    vbo.add_attrib(2, GL_FLOAT); // vec2 v_position
-    vbo.bind_data((void*)quad_vertices, 6, GL_STATIC_DRAW);
-
-    // target to render the fractal to
-    RenderTarget target_mandelbrot(screen.width(), screen.height());
+    // the view of the controls being drawn
+    View view = shared.controls.read().view;
+
+    // picks float or perturbation shaders depending on zoom
+    FractalRenderer fractal;
+
+    // tiles of iteration counts from complete frames, for views seen before
+    TileCache tile_cache(TILE_CACHE_BYTES);
+
+    // fractal iteration counts, only iterated again where the view changed
+    Reprojection frame(view.width, view.height);
+    frame.set_tile_cache(&tile_cache);
+
+    // cpu and gpu time of each pass of the frame
+    FrameProfiler profiler;
+    const int pass_fractal = profiler.add_pass("fractal");
+    const int pass_cpu     = profiler.add_pass("cpu");
+    const int pass_color   = profiler.add_pass("color");
+    const int pass_capture = profiler.add_pass("capture");
+    const int pass_text    = profiler.add_pass("text");
+    const int pass_hud     = profiler.add_pass("hud");
+    const int pass_present = profiler.add_pass("present");
+    bool show_profile = false;
+
+    // keypress to photon, in ms and frames
+    LatencyMeter latency;
+    uint64_t timed_key = 0;
+    uint64_t frames = 0;
+
+    // gl state changes made and skipped as redundant, over the last frame
+    const GLState& gl_state = GLState::current();
+    uint64_t gl_calls = 0, gl_skipped = 0;
+    uint64_t frame_gl_calls = 0, frame_gl_skipped = 0;
+
+    // internal resolution, lowered while moving if frames run long
+    ResolutionScaler scaler(FRAME_BUDGET_MS);
+
+    // mariani-silver subdivision on the cpu, instead of the shaders
+    CpuRenderer cpu;
+    cpu.set_interior_checks(fractal.interior_test() != InteriorTest::Off);
+    bool cpu_mode = false;
+
+    // iteration counts to colors, cheap enough to run every frame
+    Colorizer colorizer;
+
+    // records the colored frames, without stalling on the gpu
+    FrameCapture capture;
 
     // for writing debug texts
     Font font("NotoSansMono-Regular.ttf", 16);
-    char strbuf[64] {0};
+    char strbuf[96] {0};
+
+    // presses of each action carried out so far
+    uint32_t applied[ACTION_COUNT] = {0};
+    uint32_t seen = 0;
+
+    // startup is reported once the first frame is up
+    bool first_frame = true;
+
+    // render loop
+    while (true)
+    {
+        // idle: sleep until new controls arrive instead of redrawing at vsync;
+        // not while recording, which takes one frame per refresh
+        if ((cpu_mode || (frame.complete() && scaler.full())) && !shared.controls.read().moving
+            && !capture.active())
+            shared.published.wait(seen, std::memory_order_acquire);
+        seen = shared.published.load(std::memory_order_acquire);
+        if (shared.quit.load()) break;
+
+        // collect last frames' gpu timings, and time this one
+        profiler.begin_frame();
+        latency.collect();
+        gl_calls = gl_state.calls();
+        gl_skipped = gl_state.skipped();
+
+        // the latest controls, skipping any that came in between
+        shared.controls.update();
+        const Controls& controls = shared.controls.read();
+        view = controls.view;
+
+        // carry out actions pressed since the last frame
+        for (int i = 0; i < ACTION_COUNT; i++)
+            for (; applied[i] != controls.presses[i]; applied[i]++)
+                switch ((Action)i)
+                {
+                    case Action::Bla:
+                        fractal.set_bla_enabled(!fractal.bla_enabled());
+                        frame.invalidate();
+                        break;
+                    case Action::Smooth:
+                        colorizer.set_smooth(!colorizer.smooth());
+                        break;
+                    case Action::Interior:
+                    {
+                        // off -> periodicity -> derivative -> off
+                        const int next = ((int)fractal.interior_test() + 1) % 3;
+                        fractal.set_interior_test((InteriorTest)next);
+                        cpu.set_interior_checks(fractal.interior_test() != InteriorTest::Off);
+                        frame.invalidate();
+                        break;
+                    }
+                    case Action::Cpu:
+                        cpu_mode = !cpu_mode;
+                        frame.invalidate();
+                        cpu.invalidate();
+                        break;
+                    case Action::Verify:
+                    {
+                        if (!cpu_mode) break;
+                        const uint64_t mismatches = cpu.verify();
+                        std::clog << "mariani-silver: " << mismatches << " of "
+                            << (size_t)view.width * view.height
+                            << " pixels differ from a brute-force render" << std::endl;
+                        break;
+                    }
+                    case Action::Profile:
+                        show_profile = !show_profile;
+                        break;
+                    case Action::Capture:
+                        if (capture.active())
+                            capture.stop();
+                        else
+                            capture.start(capture_path, view.width, view.height);
+                        break;
+                    case Action::None:
+                        break;
+                }
+
+        // pick this frame's internal resolution from the last few, and
+        // tell the input thread what a pan's pixels are
+        scaler.update(controls.moving, profiler.gpu(pass_fractal));
+        shared.internal_height.store(scaler.scaled(view).height, std::memory_order_relaxed);
+
+        // draw fractal, only where it changed, and color it onto screen
+        if (cpu_mode)
+        {
+            profiler.begin(pass_cpu);
+            cpu.update(view);
+            profiler.end(pass_cpu);
+
+            profiler.begin(pass_color);
+            screen.get_rendertarget().clear(); // also calls .use()
+            colorizer.draw(cpu.iterations());
+            profiler.end(pass_color);
+        }
+        else
+        {
+            // iterate at the internal resolution, the colorizer stretches it
+            const View internal = scaler.scaled(view);
+            profiler.begin(pass_fractal);
+            frame.update(fractal, internal, (size_t)internal.width * internal.height / PREVIEW_FRAMES);
+            profiler.end(pass_fractal);
+
+            profiler.begin(pass_color);
+            screen.get_rendertarget().clear(); // also calls .use()
+            colorizer.draw(frame.iterations());
+            profiler.end(pass_color);
+        }
+
+        // record before the texts are drawn over it
+        if (capture.active())
+        {
+            ScopedPass scope(profiler, pass_capture);
+            capture.capture(screen.get_rendertarget());
+        }
+
+        // the strings are queued on the cpu, and drawn all at once in the
+        // hud pass, so one section times all of them
+        profiler.begin(pass_text);
+
+        // pos+zoom string
+        {
+            // queue text, top right
+            snprintf(strbuf, sizeof(strbuf),
+                "pos: %+.5f%+.5fi zoom: %6gx res: %3.0f%% gpu: %4.1fms",
+                view.centerx.to_double(), view.centery.to_double(), view.zoom,
+                100.0 * scaler.scale(), scaler.frame_ms());
+            std::string_view sv{strbuf};
+            font.add_text(sv, view.width - font.text_width(sv), 0);
+        }
+
+        // exponent+threshhold string
+        {
+            // the cpu only has the periodicity checks, or none
+            const InteriorTest interior = !cpu_mode? fractal.interior_test()
+                : cpu.interior_checks()? InteriorTest::Periodicity : InteriorTest::Off;
+
+            // queue text, top right
+            snprintf(strbuf, sizeof(strbuf),
+                "exp: %+2f thresh: %2f %s%s interior: %s",
+                view.exponent, view.threshhold,
+                cpu_mode? "cpu" : fractal_mode_name(fractal.mode_for(view)),
+                fractal.bla_enabled()? " bla" : "",
+                interior_test_name(interior));
+            std::string_view sv{strbuf};
+            font.add_text(sv, view.width - font.text_width(sv), 22);
+        }
+
+        // tile cache or subdivision string
+        {
+            // queue text, top right
+            const SubdivisionStats& stats = cpu.stats();
+            const uint64_t pixels = stats.iterated + stats.filled;
+            if (cpu_mode)
+                snprintf(strbuf, sizeof(strbuf),
+                    "iterated: %llu filled: %llu (%.1f%%)",
+                    (unsigned long long)stats.iterated,
+                    (unsigned long long)stats.filled,
+                    pixels? 100.0 * stats.filled / pixels : 0.0);
+            else
+                snprintf(strbuf, sizeof(strbuf),
+                    "tiles: %zu (%zuM) hits: %llu misses: %llu",
+                    tile_cache.tile_count(), tile_cache.bytes() >> 20,
+                    (unsigned long long)tile_cache.hits(),
+                    (unsigned long long)tile_cache.misses());
+            std::string_view sv{strbuf};
+            font.add_text(sv, view.width - font.text_width(sv), 44);
+        }
+
+        // capture string
+        if (capture.active())
+        {
+            // queue text, top right
+            snprintf(strbuf, sizeof(strbuf),
+                "rec: %llu frames, %llu dropped, %.2fms",
+                (unsigned long long)capture.frames_written(),
+                (unsigned long long)capture.frames_dropped(),
+                capture.capture_ms());
+            std::string_view sv{strbuf};
+            font.add_text(sv, view.width - font.text_width(sv), 66);
+        }
+
+        // profile strings, one per pass
+        if (show_profile)
+        {
+            for (int i = -1; i <= (int)profiler.pass_count() + 2; i++)
+            {
+                // queue text, top right
+                if (i < 0)
+                    snprintf(strbuf, sizeof(strbuf),
+                        "%-8s %10s %6s %6s %10s %6s %6s",
+                        "ms", "gpu avg", "p99", "max", "cpu avg", "p99", "max");
+                else if (i < (int)profiler.pass_count())
+                    snprintf(strbuf, sizeof(strbuf),
+                        "%-8s %10.2f %6.2f %6.2f %10.2f %6.2f %6.2f",
+                        profiler.name(i),
+                        profiler.gpu(i).average(), profiler.gpu(i).p99(), profiler.gpu(i).max(),
+                        profiler.cpu(i).average(), profiler.cpu(i).p99(), profiler.cpu(i).max());
+                else if (i == (int)profiler.pass_count())
+                    snprintf(strbuf, sizeof(strbuf),
+                        "%-8s %10s %6s %6s %10.2f %6.2f %6.2f",
+                        "frame", "", "", "",
+                        profiler.frame().average(), profiler.frame().p99(), profiler.frame().max());
+                else if (i == (int)profiler.pass_count() + 1)
+                    snprintf(strbuf, sizeof(strbuf),
+                        "gl state: %llu changes, %llu redundant skipped",
+                        (unsigned long long)frame_gl_calls,
+                        (unsigned long long)frame_gl_skipped);
+                else
+                    snprintf(strbuf, sizeof(strbuf),
+                        "keypress to photon: %.1fms %.1f frames, max %.1fms %.0f frames",
+                        latency.ms().average(), latency.frames().average(),
+                        latency.ms().max(), latency.frames().max());
+                std::string_view sv{strbuf};
+                font.add_text(sv, view.width - font.text_width(sv), 88 + 22 * (i + 1));
+            }
+        }
+
+        profiler.end(pass_text);
+
+        // every queued string in one draw
+        profiler.begin(pass_hud);
+        font.draw(screen.get_rendertarget(), -0.5f);
+        profiler.end(pass_hud);
+
+        // display
+        profiler.begin(pass_present);
+        screen.flip();
+        profiler.end(pass_present);
+        shared.frames.store(++frames, std::memory_order_relaxed);
+
+        // the first frame to show a keypress
+        if (controls.key_id != timed_key)
+        {
+            latency.presented(controls.key_time, controls.key_frame, frames);
+            timed_key = controls.key_id;
+        }
+
+        if (first_frame)
+        {
+            // programs compiled against loaded from shader-cache/ is what
+            // tells a cold start from a warm one
+            const ProgramStats& stats = Program::stats();
+            std::clog << "first frame after "
+                << std::chrono::duration<double, std::milli>(Clock::now() - start).count()
+                << "ms, " << stats.compiled << " programs compiled, "
+                << stats.from_binary << " loaded from " << SHADER_CACHE_DIR
+                << std::endl;
+            first_frame = false;
+        }
+        profiler.end_frame();
+        frame_gl_calls = gl_state.calls() - gl_calls;
+        frame_gl_skipped = gl_state.skipped() - gl_skipped;
+    }
+}
+
+// the render thread owns the GL context while it runs
+static void render(Screen& screen, Shared& shared, const std::string& capture_path, Clock::time_point start)
+{
+    SDL_GL_MakeCurrent(screen.window(), screen.GLContext());
+    render_loop(screen, shared, capture_path, start);
+
+    // every GL object is gone, so the screen can delete the context
+    SDL_GL_MakeCurrent(screen.window(), nullptr);
+}
+
+
+int main(int argc, char** argv)
+{
+    const Clock::time_point start = Clock::now();
+
+    // where F records to, "-" pipes raw frames to stdout for an encoder
+    std::string capture_path = "capture.rgb";
+    for (int i = 1; i < argc; i++)
+        if (std::string_view(argv[i]) == "--capture" && i + 1 < argc)
+            capture_path = argv[++i];
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--capture FILE|-]" << std::endl;
+            return 1;
+        }
+
+    Program::set_binary_cache(SHADER_CACHE_DIR);
+    Screen screen(1280, 720, "Mandelbrot");
+
+    // current view, exponent and threshhold information
+    Controls controls;
+    controls.view.max_steps = MAX_DEPTH;
+    controls.view.width = screen.width();
+    controls.view.height = screen.height();
+    Shared shared(controls);
+    shared.internal_height = controls.view.height;
+
+    // this thread keeps the events and the keyboard, the render thread
+    // takes the context; a slow frame then never holds up the controls
+    SDL_GL_MakeCurrent(screen.window(), nullptr);
+    std::thread render_thread(render,
+        std::ref(screen), std::ref(shared), std::cref(capture_path), start);
+
+    // moves the view by the keys held, in real time
+    ViewControls view_controls;
+    bool moving = false;
+    Clock::time_point last_sample = Clock::now();
 
     // fetch keyboard state pointer
     const Uint8* const keyboard = SDL_GetKeyboardState(NULL);
 
-    // main loop
+    // input loop
     SDL_Event e;
     while (true)
     {
+        // sample held keys every INPUT_INTERVAL_MS, otherwise sleep until
+        // an event arrives
+        if (moving)
+            SDL_WaitEventTimeout(NULL, INPUT_INTERVAL_MS);
+        else
+            SDL_WaitEvent(NULL);
+
         // handle events
+        bool changed = false;
         while (SDL_PollEvent(&e))
+        {
             if (!screen.process_event(e))
                 goto quit;
+            else if (e.type == SDL_WINDOWEVENT)
+                // exposed, resized and the like, draw again
+                changed = true;
             else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE)
                 goto quit;
+            else if (e.type == SDL_KEYDOWN)
+            {
+                const Action action = action_for(e.key.keysym.sym);
+                if (action != Action::None)
+                {
+                    controls.presses[(int)action]++;
+                    changed = true;
+                }
+
+                // time the first press of a key (not its repeats) until the
+                // frame that shows it is done
+                if (!e.key.repeat && (action != Action::None
+                    || ViewControls::is_view_key(e.key.keysym.scancode)))
+                {
+                    controls.key_id++;
+                    controls.key_time = Clock::now();
+                    controls.key_frame = shared.frames.load(std::memory_order_relaxed);
+                    changed = true;
+                }
+            }
+        }
 
-        // handle keyboard (arbitrary sensitivities)
-        const double lshift = keyboard[SDL_SCANCODE_LSHIFT]? 5.0 : 1.0;
-        const double deltacenter = lshift * 0.05 / zoom;
-        const double deltazoom =   lshift * 0.05;
-        const double deltaexp =    lshift * 0.005;
-        const double deltathresh = lshift * 0.05;
-        if (keyboard[SDL_SCANCODE_S])  // -imag
-            centery -= deltacenter;
-        if (keyboard[SDL_SCANCODE_W])  // +imag
-            centery += deltacenter;
-        if (keyboard[SDL_SCANCODE_A])  // -real
-            centerx -= deltacenter;
-        if (keyboard[SDL_SCANCODE_D])  // +real
-            centerx += deltacenter;
-        if (keyboard[SDL_SCANCODE_Q])  // -zoom
-            zoom -= zoom * deltazoom;
-        if (keyboard[SDL_SCANCODE_E])  // +zoom
-            zoom += zoom * deltazoom;
-        if (keyboard[SDL_SCANCODE_LEFTBRACKET])  // -exp
-            exponent -= deltaexp;
-        if (keyboard[SDL_SCANCODE_RIGHTBRACKET])  // +exp
-            exponent += deltaexp;
-        if (keyboard[SDL_SCANCODE_MINUS])  // -thresh
-            threshhold -= deltathresh;
-        if (keyboard[SDL_SCANCODE_EQUALS])  // +thresh
-            threshhold += deltathresh;
-        if (keyboard[SDL_SCANCODE_R])  // reset view
+        // handle keyboard, by the time since the last sample; a key just
+        // pressed moves FIRST_STEP_S at once
+        const Clock::time_point now = Clock::now();
+        const bool was_moving = moving;
+        moving = ViewControls::held(keyboard);
+        if (moving)
         {
-            centerx = 0.0;
-            centery = 0.0;
-            zoom = 0.4;
+            const double seconds = was_moving
+                ? std::min(std::chrono::duration<double>(now - last_sample).count(), MAX_STEP_S)
+                : FIRST_STEP_S;
+            const int internal_height = shared.internal_height.load(std::memory_order_relaxed);
+            changed |= view_controls.update(keyboard, seconds, internal_height, controls.view);
         }
-
-        // update uniforms
-        prog_mandelbrot.use();
-        glUniform1f(unif_exponent, exponent);
-        glUniform1f(unif_threshhold, threshhold);
-        glUniform2f(unif_center, centerx, centery);
-        glUniform1f(unif_zoom, zoom);
-
-        // does fractal rendertarget need resizing?
-        // FIXME
-
-        // draw fractal
-        target_mandelbrot.clear(); // also calls .use()
-        prog_mandelbrot.use();
-        vao_mandelbrot.use();
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        // blit fractal to screen
-        screen.get_rendertarget().clear(); // also calls .use()
-        screen.get_rendertarget().render_texture(
-            target_mandelbrot.color_texture(),
-            0, 0,
-            screen.width(), screen.height(),
-            0.0f);
-
-        // pos+zoom string
+        last_sample = now;
+        if (moving != was_moving)
         {
-            // draw text
-            snprintf(strbuf, sizeof(strbuf),
-                "pos: %+.5f%+.5fi zoom: %6fx",
-                centerx, centery, zoom);
-            std::string_view sv{strbuf, sizeof(strbuf)};
-            Texture strtex = font.render_text_fast_bitmap(sv, GL_RED);
-            strtex.use();
-            strtex.generate_mipmap();
-
-            // map red channel to white
-            const GLint swizzle_mask[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
-            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle_mask);
-
-            // blit texture to screen, top left
-            screen.get_rendertarget().render_texture(
-                strtex,
-                screen.width() - strtex.width(), 0,
-                strtex.width(), strtex.height(),
-                -0.5f);
+            controls.moving = moving;
+            changed = true;
         }
 
-        // exponent+threshhold string
+        // does the view need resizing?
+        if (screen.width() > 0 && screen.height() > 0)
         {
-            // draw text
-            snprintf(strbuf, sizeof(strbuf),
-                "exp: %+2f thresh: %2f",
-                exponent, threshhold);
-            std::string_view sv{strbuf, sizeof(strbuf)};
-            Texture strtex = font.render_text_fast_bitmap(sv, GL_RED);
-            strtex.use();
-            strtex.generate_mipmap();
-
-            // map red channel to white
-            const GLint swizzle_mask[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
-            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle_mask);
-
-            // blit texture to screen, top left
-            screen.get_rendertarget().render_texture(
-                strtex,
-                screen.width() - strtex.width(), 22,
-                strtex.width(), strtex.height(),
-                -0.5f);
+            controls.view.width = screen.width();
+            controls.view.height = screen.height();
         }
 
-        // display
-        screen.flip();
+        if (changed)
+            publish(shared, controls);
     }
 
 quit:
+    shared.quit = true;
+    publish(shared, controls);
+    render_thread.join();
     return 0;
 }
-
@@ -0,0 +1,153 @@
+#include "mariani-silver.hpp"
+
+#include <atomic>
+#include <vector>
+
+
+// the rectangle being rendered, all coordinates below are relative to it
+struct MarianiSilver::Region
+{
+    const FractalParams& params;
+    int width, height; // of the whole frame
+    int x0, y0;        // of the rectangle, in the frame
+    uint32_t* out;
+    size_t stride;
+    SubdivisionStats stats;
+
+    uint32_t& at(int x, int y) { return out[(size_t)y * stride + x]; }
+};
+
+
+SubdivisionStats MarianiSilver::render(
+    const FractalParams& params,
+    int width, int height,
+    uint32_t* out) const
+{
+    return render_rect(params, width, height, 0, 0, width, height, out, width);
+}
+
+SubdivisionStats MarianiSilver::render_rect(
+    const FractalParams& params,
+    int width, int height,
+    int x, int y, int w, int h,
+    uint32_t* out, size_t out_stride) const
+{
+    Region region{params, width, height, x, y, out, out_stride, {}};
+    if (w <= 0 || h <= 0) return region.stats;
+
+    // outer border: bottom and top rows, then the columns between them
+    iterate(region, 0, 0, w, 1);
+    if (h > 1)
+        iterate(region, 0, h - 1, w, 1);
+    if (h > 2)
+    {
+        iterate(region, 0, 1, 1, h - 2);
+        if (w > 1)
+            iterate(region, w - 1, 1, 1, h - 2);
+    }
+
+    subdivide(region, 0, 0, w, h);
+    return region.stats;
+}
+
+
+void MarianiSilver::iterate(Region& region, int x, int y, int w, int h) const
+{
+    if (w <= 0 || h <= 0) return;
+
+    mp_engine->render_rect(
+        region.params, region.width, region.height,
+        region.x0 + x, region.y0 + y, w, h,
+        &region.at(x, y), region.stride);
+    region.stats.iterated += (uint64_t)w * h;
+}
+
+void MarianiSilver::subdivide(Region& region, int x, int y, int w, int h) const
+{
+    // nothing inside the border
+    if (w <= 2 || h <= 2) return;
+
+    // does the whole border share one count?
+    const uint32_t value = region.at(x, y);
+    bool uniform = true;
+    for (int i = 0; i < w && uniform; i++)
+        uniform = region.at(x + i, y) == value && region.at(x + i, y + h - 1) == value;
+    for (int j = 1; j < h - 1 && uniform; j++)
+        uniform = region.at(x, y + j) == value && region.at(x + w - 1, y + j) == value;
+
+    if (uniform)
+    {
+        for (int j = 1; j < h - 1; j++)
+            for (int i = 1; i < w - 1; i++)
+                region.at(x + i, y + j) = value;
+        region.stats.filled += (uint64_t)(w - 2) * (h - 2);
+        return;
+    }
+
+    if (w < MIN_SIZE || h < MIN_SIZE)
+    {
+        iterate(region, x + 1, y + 1, w - 2, h - 2);
+        return;
+    }
+
+    // split across the longer side, the dividing line becomes a shared border
+    if (w >= h)
+    {
+        const int mid = x + w / 2;
+        iterate(region, mid, y + 1, 1, h - 2);
+        subdivide(region, x, y, mid - x + 1, h);
+        subdivide(region, mid, y, x + w - mid, h);
+    }
+    else
+    {
+        const int mid = y + h / 2;
+        iterate(region, x + 1, mid, w - 2, 1);
+        subdivide(region, x, y, w, mid - y + 1);
+        subdivide(region, x, mid, w, y + h - mid);
+    }
+}
+
+
+SubdivisionStats render_subdivided(
+    TileScheduler& scheduler,
+    const EscapeTime& engine,
+    const FractalParams& params,
+    int width, int height,
+    uint32_t* out,
+    int tile_size)
+{
+    const MarianiSilver subdivider(engine);
+    std::atomic<uint64_t> iterated{0}, filled{0};
+
+    scheduler.run(width, height, tile_size,
+        [&](const Tile& tile)
+        {
+            const SubdivisionStats stats = subdivider.render_rect(
+                params, width, height,
+                tile.x, tile.y, tile.width, tile.height,
+                out + (std::size_t)tile.y * width + tile.x, width);
+            iterated += stats.iterated;
+            filled += stats.filled;
+        });
+
+    SubdivisionStats total;
+    total.iterated = iterated;
+    total.filled = filled;
+    return total;
+}
+
+uint64_t verify_subdivided(
+    TileScheduler& scheduler,
+    const EscapeTime& engine,
+    const FractalParams& params,
+    int width, int height,
+    const uint32_t* out)
+{
+    std::vector<uint32_t> reference((std::size_t)width * height);
+    render_tiled(scheduler, engine, params, width, height, reference.data());
+
+    uint64_t mismatches = 0;
+    for (std::size_t i = 0; i < reference.size(); i++)
+        mismatches += reference[i] != out[i];
+    return mismatches;
+}
@@ -0,0 +1,84 @@
+#ifndef MARIANISILVERH
+#define MARIANISILVERH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "escape-time.hpp"
+#include "tile-scheduler.hpp"
+
+
+struct SubdivisionStats
+{
+    uint64_t iterated = 0; // pixels run through the escape-time engine
+    uint64_t filled = 0;   // pixels copied from a uniform border instead
+
+    SubdivisionStats& operator+=(const SubdivisionStats& rhs)
+    {
+        iterated += rhs.iterated;
+        filled += rhs.filled;
+        return *this;
+    }
+};
+
+
+// Mariani-Silver rendering: the set is connected, so a rectangle whose whole
+// border has one iteration count is filled with it without iterating the
+// inside; other rectangles are split in two across their longer side
+//
+// this is exact for the set itself, but a level set thinner than a pixel can
+// still slip between border pixels; verify_subdivided() counts those
+class MarianiSilver
+{
+public:
+    // rectangles narrower than this are iterated in full, splitting further
+    // would evaluate nearly every pixel as a border anyway
+    constexpr static int MIN_SIZE = 8;
+
+    explicit MarianiSilver(const EscapeTime& engine) : mp_engine(&engine) {}
+
+public:
+    // same frames, layout and arguments as EscapeTime::render()
+    SubdivisionStats render(
+        const FractalParams& params,
+        int width, int height,
+        uint32_t* out) const;
+
+    // and EscapeTime::render_rect(), subdividing only inside the rectangle
+    SubdivisionStats render_rect(
+        const FractalParams& params,
+        int width, int height,
+        int x, int y, int w, int h,
+        uint32_t* out, size_t out_stride) const;
+
+private:
+    struct Region;
+
+    // iterate the pixels of [x, x+w) * [y, y+h), relative to the region
+    void iterate(Region& region, int x, int y, int w, int h) const;
+    // the border of the rectangle is already in the region's output
+    void subdivide(Region& region, int x, int y, int w, int h) const;
+
+private:
+    const EscapeTime* mp_engine = nullptr;
+};
+
+
+// subdivide every tile of a frame on its own worker, see render_tiled()
+SubdivisionStats render_subdivided(
+    TileScheduler& scheduler,
+    const EscapeTime& engine,
+    const FractalParams& params,
+    int width, int height,
+    uint32_t* out,
+    int tile_size = 128);
+
+// brute-force render the same frame and count the pixels of out that differ
+uint64_t verify_subdivided(
+    TileScheduler& scheduler,
+    const EscapeTime& engine,
+    const FractalParams& params,
+    int width, int height,
+    const uint32_t* out);
+
+#endif // MARIANISILVERH
@@ -0,0 +1,189 @@
+#include "poster-export.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string.h>
+
+
+namespace {
+
+constexpr static const char* CHECKPOINT_MAGIC = "mandelbrot-render checkpoint 1";
+
+// everything that decides the file's contents, a checkpoint only applies to
+// an export with the same key
+static std::string checkpoint_key(const View& view, bool smooth)
+{
+    std::ostringstream key;
+    key << std::hexfloat
+        << view.centerx.to_string() << " " << view.centery.to_string()
+        << " " << view.zoom << " " << view.exponent << " " << view.threshhold
+        << " " << view.max_steps << " " << view.width << "x" << view.height
+        << " " << (smooth? "smooth" : "bands");
+    return key.str();
+}
+
+// rows already in the file, or 0 if there is no usable checkpoint
+static int read_checkpoint(const std::string& path, const std::string& key)
+{
+    std::ifstream file(path);
+    std::string magic, saved_key;
+    int rows = 0;
+    if (!std::getline(file, magic) || magic != CHECKPOINT_MAGIC
+        || !std::getline(file, saved_key) || saved_key != key
+        || !(file >> rows) || rows < 0)
+        return 0;
+    return rows;
+}
+
+// replaced whole by a rename, so a crash mid-write leaves the old one
+static bool write_checkpoint(const std::string& path, const std::string& key, int rows)
+{
+    const std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::trunc);
+        file << CHECKPOINT_MAGIC << "\n" << key << "\n" << rows << "\n";
+        if (!file) return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temp, path, error);
+    return !error;
+}
+
+} // anonymous namespace
+
+
+PosterExport::PosterExport(FractalRenderer& fractal, Colorizer& colorizer) :
+    m_fractal(fractal),
+    m_colorizer(colorizer),
+    m_iterations(1, 1, GL_RG32F),
+    m_colors(1, 1)
+{}
+
+
+std::string PosterExport::checkpoint_path(const std::string& path)
+{
+    return path + ".checkpoint";
+}
+
+View PosterExport::sub_view(const View& view, int x, int y, int width, int height)
+{
+    // pixels are square, the same size in both directions
+    const double step = 2.0 / (view.zoom * view.height);
+
+    View out = view;
+    out.centerx += (x + 0.5 * width - 0.5 * view.width) * step;
+    out.centery += (y + 0.5 * height - 0.5 * view.height) * step;
+    out.zoom = view.zoom * view.height / height;
+    out.width = width;
+    out.height = height;
+    return out;
+}
+
+
+void PosterExport::render_band(const View& view, int top, int height)
+{
+    const std::size_t band_row = (std::size_t)view.width * 3;
+    m_band.resize(band_row * height);
+
+    const int bottom = view.height - top - height;
+    for (int x = 0; x < view.width; x += TILE_WIDTH)
+    {
+        const int width = std::min(TILE_WIDTH, view.width - x);
+
+        m_iterations.resize(width, height);
+        m_colors.resize(width, height);
+
+        m_iterations.use();
+        m_fractal.draw(sub_view(view, x, bottom, width, height));
+
+        m_colors.clear(); // also calls .use()
+        m_colorizer.draw(m_iterations.color_texture());
+        m_colors.read_rgb(m_tile);
+
+        // tiles come back bottom row first
+        const std::size_t tile_row = (std::size_t)width * 3;
+        for (int r = 0; r < height; r++)
+            memcpy(m_band.data() + (height - 1 - r) * band_row + (std::size_t)x * 3,
+                m_tile.data() + r * tile_row, tile_row);
+    }
+}
+
+bool PosterExport::run(const View& view, bool smooth, const std::string& path)
+{
+    m_colorizer.set_smooth(smooth);
+    m_resumed_rows = 0;
+
+    std::ostringstream header;
+    header << "P6\n" << view.width << " " << view.height << "\n255\n";
+    const std::size_t row_bytes = (std::size_t)view.width * 3;
+
+    // nothing to resume in a single band
+    const bool checkpoints = view.height > BAND_HEIGHT;
+    const std::string checkpoint = checkpoint_path(path);
+    const std::string key = checkpoint_key(view, smooth);
+
+    // resume only if the file really holds the rows the checkpoint claims
+    std::fstream file;
+    if (checkpoints)
+    {
+        const int rows = std::min(read_checkpoint(checkpoint, key), view.height);
+        std::error_code error;
+        const std::uintmax_t size = std::filesystem::file_size(path, error);
+        if (rows > 0 && !error && size >= header.str().size() + rows * row_bytes)
+        {
+            file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(header.str().size() + rows * row_bytes);
+            if (file) m_resumed_rows = rows;
+            else file.close();
+        }
+    }
+    if (!file.is_open())
+    {
+        file.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+        file << header.str();
+    }
+    if (!file)
+    {
+        std::cerr << "could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    for (int top = m_resumed_rows; top < view.height; top += BAND_HEIGHT)
+    {
+        const int height = std::min(BAND_HEIGHT, view.height - top);
+        render_band(view, top, height);
+
+        // rows have to reach the file before the checkpoint says they did
+        file.write((const char*)m_band.data(), m_band.size());
+        file.flush();
+        if (!file)
+        {
+            std::cerr << "\ncould not write " << path << std::endl;
+            return false;
+        }
+
+        if (checkpoints)
+        {
+            if (!write_checkpoint(checkpoint, key, top + height))
+                std::cerr << "\ncould not write checkpoint " << checkpoint << std::endl;
+            std::cout << "\r" << path << ": " << top + height << "/" << view.height
+                << " rows" << std::flush;
+        }
+    }
+    if (checkpoints)
+        std::cout << std::endl;
+
+    file.close();
+    if (!file)
+    {
+        std::cerr << "could not write " << path << std::endl;
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::remove(checkpoint, error);
+    return true;
+}
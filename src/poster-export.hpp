@@ -0,0 +1,61 @@
+#ifndef POSTEREXPORTH
+#define POSTEREXPORTH
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "colorizer.hpp"
+#include "fractal-renderer.hpp"
+#include "rendertarget.hpp"
+#include "view.hpp"
+
+
+// renders a View of any size into a binary ppm, one band of rows at a time
+//
+// each band is drawn as tiles (sub-views of the full view, so no texture
+// needs to be as large as the image), colored, and appended to the file in
+// scanline order, so memory stays at one band however large the image is.
+// after each band the rows done so far go to a checkpoint next to the file,
+// and a later export of the same view picks up from there
+class PosterExport
+{
+public:
+    constexpr static int TILE_WIDTH = 1024;
+    constexpr static int BAND_HEIGHT = 64;
+
+    PosterExport(FractalRenderer& fractal, Colorizer& colorizer);
+
+    PosterExport(const PosterExport&) = delete;
+    PosterExport& operator=(const PosterExport&) = delete;
+
+public:
+    // false (after printing why) if the file could not be written; progress
+    // is printed to stdout for images of more than one band
+    bool run(const View& view, bool smooth, const std::string& path);
+
+    // rows picked up from a checkpoint by the last run
+    int resumed_rows(void) const { return m_resumed_rows; }
+
+    static std::string checkpoint_path(const std::string& path);
+
+private:
+    // the rect (x, y from the bottom, GL order) of view, as its own view
+    static View sub_view(const View& view, int x, int y, int width, int height);
+
+    // draw rows [top, top + height) of the image, counted from the top, into
+    // m_band
+    void render_band(const View& view, int top, int height);
+
+private:
+    FractalRenderer& m_fractal;
+    Colorizer& m_colorizer;
+
+    RenderTarget m_iterations;
+    RenderTarget m_colors;
+    std::vector<uint8_t> m_tile, m_band;
+
+    int m_resumed_rows = 0;
+};
+
+#endif // POSTEREXPORTH
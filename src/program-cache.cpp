@@ -0,0 +1,31 @@
+#include "program-cache.hpp"
+
+
+const Program& ProgramCache::get(
+    const std::filesystem::path& vert, const std::filesystem::path& frag,
+    const ShaderDefines& defines)
+{
+    // defines are sorted by name, so equal sets give equal keys
+    std::string key = vert.string() + '\n' + frag.string() + '\n';
+    for (const auto& [name, value] : defines)
+        key += name + '=' + value + '\n';
+
+    std::unique_ptr<Program>& prog = m_programs[key];
+    if (!prog)
+        prog = std::make_unique<Program>(vert, frag, defines);
+    return *prog;
+}
+
+const Program& ProgramCache::get_compute(
+    const std::filesystem::path& comp, const ShaderDefines& defines)
+{
+    // no vertex and fragment pair has an empty line in its key
+    std::string key = comp.string() + "\n\n";
+    for (const auto& [name, value] : defines)
+        key += name + '=' + value + '\n';
+
+    std::unique_ptr<Program>& prog = m_programs[key];
+    if (!prog)
+        prog = std::make_unique<Program>(comp, defines);
+    return *prog;
+}
@@ -0,0 +1,32 @@
+#ifndef PROGRAMCACHEH
+#define PROGRAMCACHEH
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "program.hpp"
+
+
+// shader variants by source files and defines, each built when first asked
+// for and kept for the lifetime of the cache. variants asked for before any
+// of them is used compile in parallel, see Program
+class ProgramCache
+{
+public:
+    const Program& get(
+        const std::filesystem::path& vert, const std::filesystem::path& frag,
+        const ShaderDefines& defines = {});
+
+    // a compute shader variant
+    const Program& get_compute(
+        const std::filesystem::path& comp, const ShaderDefines& defines = {});
+
+    std::size_t size(void) const { return m_programs.size(); }
+
+private:
+    std::unordered_map<std::string, std::unique_ptr<Program>> m_programs;
+};
+
+#endif // PROGRAMCACHEH
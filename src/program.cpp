@@ -1,9 +1,16 @@
 #include "program.hpp"
 
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
 #include <iostream>
 #include <iomanip>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include "gl-state.hpp"
 
 
 static inline void print_shader_log(GLuint id)
@@ -92,82 +99,413 @@ static inline file_data read_file(std::filesystem::path path)
 }
 
 
-Program::Program(std::filesystem::path vsrc, std::filesystem::path fsrc)
+// #include "file" lines are replaced by the file, relative to the shader
+// including it; false if any file is missing or empty
+static bool read_source(const std::filesystem::path& path, std::string& source, int depth = 0)
+{
+    // nothing needs more, and this stops includes that go in circles
+    constexpr int MAX_INCLUDE_DEPTH = 8;
+
+    const file_data file = read_file(path);
+    if (file.size == 0 || depth > MAX_INCLUDE_DEPTH) return false;
+
+    const std::string_view text{ file.data, (std::size_t)file.size };
+    int line_number = 0;
+    for (std::size_t start = 0; start < text.size();)
+    {
+        std::size_t end = text.find('\n', start);
+        end = (end == std::string_view::npos)? text.size() : end + 1;
+        const std::string_view line = text.substr(start, end - start);
+        start = end;
+        line_number++;
+
+        const std::size_t open = line.find('"');
+        const std::size_t close = line.rfind('"');
+        if (line.compare(0, 9, "#include ") != 0 || open == close)
+        {
+            source += line;
+            continue;
+        }
+
+        // line numbers in compile errors restart in the included file, and
+        // pick up again after it
+        const std::string_view name = line.substr(open + 1, close - open - 1);
+        source += "#line 1\n";
+        if (!read_source(path.parent_path() / name, source, depth + 1))
+            return false;
+        if (source.back() != '\n') source += '\n';
+        source += "#line " + std::to_string(line_number + 1) + "\n";
+    }
+    return true;
+}
+
+
+static inline std::string with_defines(std::string source, const ShaderDefines& defines)
+{
+    if (defines.empty()) return source;
+
+    // #version must stay the first line, so defines go right after it
+    std::size_t insert_at = 0;
+    int next_line = 1;
+    if (source.compare(0, 8, "#version") == 0)
+    {
+        insert_at = source.find('\n');
+        insert_at = (insert_at == std::string::npos)? source.size() : insert_at + 1;
+        next_line = 2;
+    }
+
+    std::string block;
+    for (const auto& [name, value] : defines)
+        block += "#define " + name + " " + value + "\n";
+
+    // keep line numbers in compile errors matching the file
+    block += "#line " + std::to_string(next_line) + "\n";
+
+    source.insert(insert_at, block);
+    return source;
+}
+
+
+namespace {
+
+std::filesystem::path s_binary_cache;
+ProgramStats s_stats;
+
+// cache files start with this
+constexpr char BINARY_MAGIC[8] = {'M', 'B', 'P', 'R', 'O', 'G', 'B', 'N'};
+constexpr uint32_t BINARY_VERSION = 1;
+
+// anything larger is not a binary we wrote
+constexpr uint64_t MAX_BINARY_SIZE = 64u << 20;
+
+struct BinaryHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t format; // from glGetProgramBinary
+    uint64_t key_size;
+    uint64_t binary_size;
+    // then the key, then the binary
+};
+
+// 64-bit FNV-1a, to name cache files by key
+uint64_t fnv1a(std::string_view data)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : data)
+    {
+        hash ^= (uint8_t)c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// let the driver compile on as many threads as it likes, so compiles and
+// links return right away and run in the background
+void enable_parallel_compile(void)
+{
+    static bool s_enabled = false;
+    if (s_enabled) return;
+    s_enabled = true;
+
+    if (GLEW_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xffffffffu);
+    else if (GLEW_ARB_parallel_shader_compile)
+        glMaxShaderCompilerThreadsARB(0xffffffffu);
+}
+
+// some drivers have the entry points but no binary formats
+bool binaries_supported(void)
 {
+    static int s_supported = -1;
+    if (s_supported < 0)
+    {
+        GLint formats = 0;
+        if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        s_supported = formats > 0;
+    }
+    return s_supported;
+}
+
+// a binary only loads on the driver that wrote it
+const std::string& driver_string(void)
+{
+    static std::string s_driver;
+    if (s_driver.empty())
+        for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION})
+        {
+            const GLubyte* str = glGetString(name);
+            s_driver += str? (const char*)str : "";
+            s_driver += '\n';
+        }
+    return s_driver;
+}
+
+// hand the binary cached for key to prog, false if there is none or it was
+// written for another key. whether the driver took it shows at link status
+bool load_binary(const std::filesystem::path& path, const std::string& key, GLuint prog)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    BinaryHeader header;
+    if (!file.read((char*)&header, sizeof(header))
+        || memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0
+        || header.version != BINARY_VERSION
+        || header.key_size != key.size()
+        || header.binary_size == 0 || header.binary_size > MAX_BINARY_SIZE)
+        return false;
+
+    // the whole key, not only its hash in the name, has to match
+    std::string stored(key.size(), '\0');
+    if (!file.read(stored.data(), stored.size()) || stored != key)
+        return false;
+
+    std::vector<char> binary(header.binary_size);
+    if (!file.read(binary.data(), binary.size()))
+        return false;
+
+    glProgramBinary(prog, header.format, binary.data(), (GLsizei)binary.size());
+    return true;
+}
+
+void save_binary(const std::filesystem::path& path, const std::string& key, GLuint prog)
+{
+    GLint length = 0;
+    glGetProgramiv(prog, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(prog, length, &length, &format, binary.data());
+    if (length <= 0) return;
+
+    BinaryHeader header;
+    memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.format = format;
+    header.key_size = key.size();
+    header.binary_size = (uint64_t)length;
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    // written aside and renamed over, so no run sees half a file
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary);
+        file.write((const char*)&header, sizeof(header));
+        file.write(key.data(), key.size());
+        file.write(binary.data(), length);
+        if (!file)
+        {
+            std::cerr << "failed to write program binary " << std::quoted(temp.c_str()) << std::endl;
+            return;
+        }
+    }
+    std::filesystem::rename(temp, path, error);
+    if (error)
+        std::cerr << "failed to write program binary " << std::quoted(path.c_str()) << std::endl;
+}
+
+const char* stage_name(GLenum type)
+{
+    switch (type)
+    {
+        case GL_VERTEX_SHADER:   return "vertex";
+        case GL_FRAGMENT_SHADER: return "fragment";
+        case GL_COMPUTE_SHADER:  return "compute";
+    }
+    return "unknown";
+}
+
+} // anonymous namespace
+
+
+struct Program::Pending
+{
+    struct Stage
+    {
+        GLenum type;
+        std::string source;
+        GLuint id = 0;
+    };
+    std::vector<Stage> stages;
+
+    // empty without a binary cache
+    std::string key;
+    std::filesystem::path cache_path;
+    bool from_binary = false;
+
+    // compile every stage and link them into prog, without waiting for any
+    void start_build(GLuint prog, bool retrievable)
+    {
+        for (Stage& stage : stages)
+        {
+            const char* data = stage.source.c_str();
+            const GLint size = (GLint)stage.source.size();
+            stage.id = glCreateShader(stage.type);
+            glShaderSource(stage.id, 1, &data, &size);
+            glCompileShader(stage.id);
+        }
+
+        for (const Stage& stage : stages)
+            glAttachShader(prog, stage.id);
+        if (retrievable)
+            glProgramParameteri(prog, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(prog);
+    }
+};
+
+
+Program::Program(
+    std::filesystem::path vsrc, std::filesystem::path fsrc,
+    const ShaderDefines& defines)
+{
+    start({ { GL_VERTEX_SHADER, vsrc }, { GL_FRAGMENT_SHADER, fsrc } }, defines);
+}
+
+Program::Program(std::filesystem::path csrc, const ShaderDefines& defines)
+{
+    start({ { GL_COMPUTE_SHADER, csrc } }, defines);
+}
+
+void Program::start(
+    std::initializer_list<std::pair<GLenum, std::filesystem::path>> files,
+    const ShaderDefines& defines)
+{
+    enable_parallel_compile();
+
+    mp_pending = std::make_unique<Pending>();
+    Pending& pending = *mp_pending;
+
     // read files
-    file_data vertfile = read_file(vsrc);
-    file_data fragfile = read_file(fsrc);
+    for (const auto& [type, path] : files)
+    {
+        std::string source;
+        if (!read_source(path, source))
+        {
+            std::cerr << "failed to read shaders for program creation" << std::endl;
+            exit(2);
+        }
+        pending.stages.push_back({ type, with_defines(std::move(source), defines) });
+    }
+
+    m_id = glCreateProgram();
 
-    if (vertfile.size == 0 || fragfile.size == 0)
+    if (!s_binary_cache.empty() && binaries_supported())
     {
-        std::cerr << "failed to read shaders for program creation" << std::endl;
-        exit(2);
+        // the defines and includes are in the sources by now
+        pending.key = driver_string();
+        for (const Pending::Stage& stage : pending.stages)
+            pending.key += '\0' + stage.source;
+
+        char name[32];
+        snprintf(name, sizeof(name), "%016" PRIx64 ".bin", fnv1a(pending.key));
+        pending.cache_path = s_binary_cache / name;
+        pending.from_binary = load_binary(pending.cache_path, pending.key, m_id);
     }
 
-    // compile shaders
-    GLuint vertid = glCreateShader(GL_VERTEX_SHADER);
-    GLuint fragid = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(vertid, 1, &vertfile.data, &vertfile.size);
-    glShaderSource(fragid, 1, &fragfile.data, &fragfile.size);
-    glCompileShader(vertid);
-    glCompileShader(fragid);
+    if (!pending.from_binary)
+        pending.start_build(m_id, !pending.key.empty());
+}
+
+Program::~Program(void)
+{
+    // a variant built but never used still goes to the binary cache, so the
+    // next run does not compile it again
+    if (mp_pending && !mp_pending->key.empty())
+        finish();
+    if (mp_pending)
+    {
+        for (const Pending::Stage& stage : mp_pending->stages)
+            glDeleteShader(stage.id);
+    }
+    if (m_id)
+    {
+        GLState::current().forget_program(m_id);
+        glDeleteProgram(m_id);
+    }
+}
+
+void Program::finish(void) const
+{
+    if (!mp_pending) return;
+    Pending& pending = *mp_pending;
+
+    if (pending.from_binary)
+    {
+        GLint success = GL_FALSE;
+        glGetProgramiv(m_id, GL_LINK_STATUS, &success);
+        if (success == GL_TRUE)
+        {
+            s_stats.from_binary++;
+            mp_pending.reset();
+            return;
+        }
+
+        // the driver changed under the same version string, or refuses
+        // binaries after all; build it like there was no cache
+        s_stats.rejected++;
+        pending.start_build(m_id, true);
+    }
 
     // check compilation status
-    GLint vertsuccess = GL_FALSE;
-    GLint fragsuccess = GL_FALSE;
-    glGetShaderiv(vertid, GL_COMPILE_STATUS, &vertsuccess);
-    glGetShaderiv(fragid, GL_COMPILE_STATUS, &fragsuccess);
-    if (vertsuccess != GL_TRUE || fragsuccess != GL_TRUE)
+    bool compiled = true;
+    for (const Pending::Stage& stage : pending.stages)
+    {
+        GLint success = GL_FALSE;
+        glGetShaderiv(stage.id, GL_COMPILE_STATUS, &success);
+        compiled = compiled && success == GL_TRUE;
+    }
+    if (!compiled)
     {
         std::cerr << "failed to compile shaders for program creation";
-        std::cerr << "\nvertex shader log: \n";
-        print_shader_log(vertid);
-        std::cerr << "\nfragment shader log: \n";
-        print_shader_log(fragid);
-
-        glDeleteShader(vertid);
-        glDeleteShader(fragid);
+        for (const Pending::Stage& stage : pending.stages)
+        {
+            std::cerr << "\n" << stage_name(stage.type) << " shader log: \n";
+            print_shader_log(stage.id);
+        }
         exit(3);
     }
 
-    // link program
-    GLuint progid = glCreateProgram();
-    glAttachShader(progid, vertid);
-    glAttachShader(progid, fragid);
-    glLinkProgram(progid);
-
     // check linkage status
     GLint progsuccess = GL_FALSE;
-    glGetProgramiv(progid, GL_LINK_STATUS, &progsuccess);
+    glGetProgramiv(m_id, GL_LINK_STATUS, &progsuccess);
     if (progsuccess != GL_TRUE)
     {
         std::cerr << "failed to link program";
         std::cerr << "\nprogram log:\n";
-        print_program_log(progid);
-
-        glDeleteShader(vertid);
-        glDeleteShader(fragid);
-        glDeleteProgram(progid);
+        print_program_log(m_id);
         exit(4);
     }
 
-    // all good!
-    m_id = progid;
-}
+    // the linked program keeps what it needs
+    for (const Pending::Stage& stage : pending.stages)
+    {
+        glDetachShader(m_id, stage.id);
+        glDeleteShader(stage.id);
+    }
 
-Program::~Program(void)
-{
-    if (m_id)
-        glDeleteProgram(m_id);
+    // all good!
+    s_stats.compiled++;
+    if (!pending.key.empty())
+        save_binary(pending.cache_path, pending.key, m_id);
+    mp_pending.reset();
 }
 
 void Program::use(void) const
 {
-    glUseProgram(m_id);
+    finish();
+    GLState::current().use_program(m_id);
 }
 
 GLint Program::get_uniform(std::string_view name) const
 {
+    finish();
+
     // std::string_view does not have a null termination
     std::string name_str{ name };
 
@@ -181,3 +519,14 @@ GLint Program::get_uniform(std::string_view name) const
     }
     return attr;
 }
+
+
+void Program::set_binary_cache(std::filesystem::path dir)
+{
+    s_binary_cache = std::move(dir);
+}
+
+const ProgramStats& Program::stats(void)
+{
+    return s_stats;
+}
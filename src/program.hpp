@@ -2,27 +2,80 @@
 #define PROGRAMH
 
 #include <filesystem>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <string>
 #include <string_view>
+#include <utility>
 
 #include <GL/glew.h>
 #include <GL/gl.h>
 
 
+// name -> value, injected as #define lines right after #version
+using ShaderDefines = std::map<std::string, std::string>;
+
+
+// programs built so far, by how they were built
+struct ProgramStats
+{
+    int compiled = 0;      // from source
+    int from_binary = 0;   // from the binary cache
+    int rejected = 0;      // cached binaries the driver refused, then compiled
+};
+
+
+// a vertex and fragment shader pair, or a compute shader, linked. sources
+// may #include "file" relative to themselves
+//
+// the constructor only starts compiling and linking; the result is waited
+// for and checked on first use, so programs constructed one after another
+// compile in parallel where the driver can (KHR_parallel_shader_compile).
+// with a binary cache set, linked programs are saved to it and later runs
+// load them instead of compiling, keyed by the sources after defines and
+// the driver, so a changed shader or driver never loads a stale binary
 class Program
 {
 public:
-    Program(std::filesystem::path vert, std::filesystem::path frag);
+    Program(
+        std::filesystem::path vert, std::filesystem::path frag,
+        const ShaderDefines& defines = {});
+    // a compute shader on its own
+    explicit Program(std::filesystem::path comp, const ShaderDefines& defines = {});
     ~Program(void);
 
+    Program(const Program& rhs) = delete;
+    Program& operator=(const Program& rhs) = delete;
+
 public:
-    GLuint get_id(void) const { return m_id; }
+    GLuint get_id(void) const { finish(); return m_id; }
 
     GLint get_uniform(std::string_view name) const;
 
     void use(void) const;
 
+    // directory for program binaries, created when first written to; empty
+    // (the default) disables the cache. set it before building programs
+    static void set_binary_cache(std::filesystem::path dir);
+
+    static const ProgramStats& stats(void);
+
+private:
+    struct Pending;
+
+    // read, and start compiling and linking, shaders of these types
+    void start(
+        std::initializer_list<std::pair<GLenum, std::filesystem::path>> files,
+        const ShaderDefines& defines);
+
+    // wait for the build the constructor started, and check it
+    void finish(void) const;
+
 private:
-    GLuint m_id = 0;
+    mutable GLuint m_id = 0;
+    // what finish() needs, until it ran
+    mutable std::unique_ptr<Pending> mp_pending;
 };
 
 #endif // PROGRAMH
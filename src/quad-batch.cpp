@@ -0,0 +1,97 @@
+#include "quad-batch.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include "gl-state.hpp"
+
+
+QuadBatch::QuadBatch(void) :
+    m_prog(
+        std::filesystem::path{"shaders/quad-batch.vert"},
+        std::filesystem::path{"shaders/quad-batch.frag"})
+{
+    // corners come from gl_VertexID, every attribute is per quad
+    m_vao.add_vertex_buffer(sizeof(QuadInstance), 1);
+    auto& vbo = m_vao.get_buffer(0);
+    vbo.add_attrib(4, GL_FLOAT); // vec4 v_rect
+    vbo.add_attrib(1, GL_FLOAT); // float v_z
+    vbo.add_attrib(1, GL_INT);   // int v_unit
+
+    m_unif_screen_size = m_prog.get_uniform("screen_size");
+
+    // textures[i] reads from slot i
+    m_prog.use();
+    for (int i = 0; i < TEXTURE_UNITS; i++)
+        glUniform1i(m_prog.get_uniform("textures[" + std::to_string(i) + "]"), i);
+}
+
+
+void QuadBatch::add(
+    const Texture& texture,
+    float x, float y,
+    float width, float height,
+    float z)
+{
+    m_quads.push_back(Quad{&texture, x, y, width, height, z});
+}
+
+void QuadBatch::draw(RenderTarget& target, Mode mode)
+{
+    m_draw_calls = 0;
+    if (m_quads.empty()) return;
+
+    // quads of a texture together, in the order they were added
+    std::stable_sort(m_quads.begin(), m_quads.end(),
+        [](const Quad& a, const Quad& b) { return a.texture->id() < b.texture->id(); });
+
+    target.use();
+    m_prog.use();
+
+    GLState& gl = GLState::current();
+    gl.polygon_mode(GL_FILL);
+    gl.set_enabled(GL_CULL_FACE, false);
+    gl.set_enabled(GL_DEPTH_TEST, mode == Mode::Overlay);
+    gl.set_enabled(GL_BLEND, mode == Mode::Overlay);
+    if (mode == Mode::Overlay)
+        gl.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUniform2i(m_unif_screen_size, target.width(), target.height());
+
+    m_vao.use();
+    auto& vbo = m_vao.get_buffer(0);
+
+    std::size_t first = 0;
+    while (first < m_quads.size())
+    {
+        // take quads until a texture past the last unit comes up
+        m_instances.clear();
+        int units = 0;
+        GLuint bound = 0;
+        std::size_t last = first;
+        for (; last < m_quads.size(); last++)
+        {
+            const Quad& q = m_quads[last];
+            if (units == 0 || q.texture->id() != bound)
+            {
+                if (units == TEXTURE_UNITS) break;
+                gl.active_texture(units);
+                q.texture->use();
+                bound = q.texture->id();
+                units++;
+            }
+            m_instances.push_back(QuadInstance{
+                q.x, q.y, q.width, q.height, q.z, units - 1});
+        }
+
+        // fresh storage each draw, so the gpu never waits on the last one
+        vbo.bind_data(m_instances.data(), (GLsizei)m_instances.size(), GL_STREAM_DRAW);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)m_instances.size());
+        m_draw_calls++;
+
+        first = last;
+    }
+    gl.active_texture(0);
+
+    m_quads.clear();
+}
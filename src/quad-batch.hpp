@@ -0,0 +1,90 @@
+#ifndef QUADBATCHH
+#define QUADBATCHH
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include "program.hpp"
+#include "rendertarget.hpp"
+#include "texture.hpp"
+#include "vertex-array.hpp"
+
+
+// collects textured quads, like RenderTarget::render_texture() draws one at
+// a time, and draws them all with a few instanced draws
+//
+// quads are sorted by texture, and every run of up to TEXTURE_UNITS textures
+// is one draw, so thousands of quads over a handful of textures is a handful
+// of draws. state and uniforms are set once per draw(), not once per quad.
+// overlay quads are depth tested like render_texture()'s; blended quads
+// overlapping at the same z draw in texture order rather than in the order
+// added
+class QuadBatch
+{
+public:
+    // texture units one draw samples from, the least GL 3.3 guarantees;
+    // quad-batch.frag picks a quad's unit from a sampler array of this size
+    constexpr static int TEXTURE_UNITS = 16;
+
+    enum class Mode : uint8_t
+    {
+        Overlay, // blended and depth tested, like render_texture()
+        Copy,    // texels written as they are, for data like iteration counts
+    };
+
+    QuadBatch(void);
+
+    QuadBatch(const QuadBatch&) = delete;
+    QuadBatch& operator=(const QuadBatch&) = delete;
+
+public:
+    // same arguments as RenderTarget::render_texture(), though positions may
+    // fall between pixels; texture must still exist at draw()
+    void add(
+        const Texture& texture,
+        float x, float y, // position, in screen-space (x=[0,w) and y=[0,h))
+        float width, float height, // size, in screen-space
+        float z); // z, in clip-space (z=[-1,1])
+
+    size_t size(void) const { return m_quads.size(); }
+
+    // draw every quad onto target, and empty the batch
+    void draw(RenderTarget& target, Mode mode = Mode::Overlay);
+
+    // instanced draws the last draw() took
+    int last_draw_calls(void) const { return m_draw_calls; }
+
+private:
+    struct Quad
+    {
+        const Texture* texture;
+        float x, y, width, height;
+        float z;
+    };
+
+    // one quad, in the layout of shaders/quad-batch.vert's per-instance
+    // attributes
+    struct QuadInstance
+    {
+        float x, y, width, height; // in pixels from the top left
+        float z;
+        int32_t unit; // index into the draw's textures
+    };
+
+private:
+    // both keep their capacity between draws, so batches after the first
+    // do not allocate
+    std::vector<Quad> m_quads;
+    std::vector<QuadInstance> m_instances;
+    int m_draw_calls = 0;
+
+    VertexArray m_vao;
+    Program m_prog;
+    GLint m_unif_screen_size = -1;
+};
+
+#endif // QUADBATCHH
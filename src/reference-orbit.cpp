@@ -0,0 +1,45 @@
+#include "reference-orbit.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+int reference_precision(double zoom, int height)
+{
+    // pixel size is 2 / (zoom * height), keep 64 more bits than that
+    const double bits = std::log2(std::max(zoom, 1.0) * std::max(height, 1)) + 64.0;
+    return (int)std::ceil(bits / 32.0) + 1;
+}
+
+
+void ReferenceOrbit::compute(
+    const BigFixed& center_x, const BigFixed& center_y,
+    int frac_limbs,
+    double threshhold, uint32_t max_steps)
+{
+    m_x.clear();
+    m_y.clear();
+    m_x.reserve(max_steps + 2);
+    m_y.reserve(max_steps + 2);
+
+    BigFixed cx = center_x, cy = center_y;
+    cx.set_precision(frac_limbs);
+    cy.set_precision(frac_limbs);
+
+    BigFixed zx(0.0, frac_limbs), zy(0.0, frac_limbs);
+    m_x.push_back(0.0);
+    m_y.push_back(0.0);
+
+    const double sqthresh = threshhold * threshhold;
+    for (uint32_t n = 0; n <= max_steps; n++)
+    {
+        const BigFixed zxy = zx * zy;
+        zx = zx * zx - zy * zy + cx;
+        zy = zxy + zxy + cy;
+
+        const double x = zx.to_double(), y = zy.to_double();
+        m_x.push_back(x);
+        m_y.push_back(y);
+        if (x*x + y*y >= sqthresh) break;
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef REFERENCEORBITH
+#define REFERENCEORBITH
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "bigfixed.hpp"
+
+
+// fraction limbs needed to resolve single pixels of a frame of the given
+// height at the given zoom, plus guard bits
+int reference_precision(double zoom, int height);
+
+
+// high precision orbit of a single reference point for perturbation
+//
+// iterates z -> z^2 + c from z = 0, so point n is the standard z_n and the
+// pixel shaders' first z (= c) is point 1; points are rounded to double once
+// computed, since only the deltas around them need the extra range
+class ReferenceOrbit
+{
+public:
+    // stops after the first point with |z| >= threshhold, or after the
+    // max_steps+1 points a never-escaping pixel can need
+    void compute(
+        const BigFixed& cx, const BigFixed& cy,
+        int frac_limbs,
+        double threshhold, uint32_t max_steps);
+
+    size_t size(void) const { return m_x.size(); }
+    double x(size_t n) const { return m_x[n]; }
+    double y(size_t n) const { return m_y[n]; }
+
+private:
+    std::vector<double> m_x, m_y;
+};
+
+#endif // REFERENCEORBITH
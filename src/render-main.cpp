@@ -0,0 +1,318 @@
+// mandelbrot-render: renders views straight to image files, with no window
+//
+// every job shares one headless context, so shader variants are compiled
+// once for the whole batch. images of any size are drawn a band at a time
+// (see PosterExport), and an interrupted one picks up where it stopped
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits.h>
+#include <sstream>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "colorizer.hpp"
+#include "fractal-renderer.hpp"
+#include "headless-context.hpp"
+#include "poster-export.hpp"
+#include "program.hpp"
+#include "view.hpp"
+#include "zoom-video.hpp"
+
+
+
+// linked programs are kept here between runs, like the viewer does
+constexpr static const char* SHADER_CACHE_DIR = "shader-cache";
+
+static const char* const USAGE =
+    "usage: mandelbrot-render [options] [--jobs FILE]\n"
+    "\n"
+    "  --center X Y       center, as decimals (kept exact for deep zooms)\n"
+    "  --zoom Z           zoom, 1 fits [-1,1] vertically\n"
+    "  --exponent E       z^E + c\n"
+    "  --threshhold T     escape radius\n"
+    "  --max-steps N      iteration limit\n"
+    "  --size WxH         output size in pixels\n"
+    "  --smooth           smooth coloring instead of bands\n"
+    "  --output FILE      binary ppm to write\n"
+    "  --frames N         zoom video instead: N frames from --start-zoom in to\n"
+    "                     --zoom, written to --output with its run of '#'\n"
+    "                     replaced by the frame number\n"
+    "  --start-zoom Z     zoom of a video's first frame\n"
+    "  --jobs FILE        one job per line, each line holds options that\n"
+    "                     override the command line's ('#' starts a comment)\n";
+
+
+struct RenderJob
+{
+    View view;
+    bool smooth = false;
+    std::string output;
+
+    // a zoom video of this many frames, if not 0
+    int frames = 0;
+    double start_zoom = View().zoom;
+};
+
+
+static std::vector<std::string> split_words(const std::string& line)
+{
+    std::vector<std::string> words;
+    std::istringstream stream(line);
+    for (std::string word; stream >> word;)
+    {
+        if (word[0] == '#') break;
+        words.push_back(word);
+    }
+    return words;
+}
+
+// apply options to job, or print what is wrong and return false
+static bool parse_options(const std::vector<std::string>& args, RenderJob& job, std::string* jobs_file)
+{
+    for (std::size_t i = 0; i < args.size(); i++)
+    {
+        const std::string& opt = args[i];
+        const auto value = [&](int k) -> const std::string*
+        {
+            if (i + k >= args.size())
+            {
+                std::cerr << "missing value for " << opt << std::endl;
+                return nullptr;
+            }
+            return &args[i + k];
+        };
+        const auto number = [&](const std::string* text, double& out)
+        {
+            if (text == nullptr) return false;
+            char* end = nullptr;
+            out = strtod(text->c_str(), &end);
+            if (end == text->c_str() || *end != '\0')
+            {
+                std::cerr << "bad number for " << opt << ": " << *text << std::endl;
+                return false;
+            }
+            return true;
+        };
+        // a whole count in [lo, hi]; anything past hi would not survive the cast
+        const auto count = [&](const std::string* text, double lo, double hi, double& out)
+        {
+            if (!number(text, out)) return false;
+            if (!(out >= lo && out <= hi))
+            {
+                std::cerr << "bad number for " << opt << ": " << *text << std::endl;
+                return false;
+            }
+            return true;
+        };
+
+        double d = 0.0;
+        if (opt == "--help" || opt == "-h")
+        {
+            std::cout << USAGE;
+            exit(0);
+        }
+        else if (opt == "--center")
+        {
+            const std::string* x = value(1);
+            const std::string* y = value(2);
+            if (x == nullptr || y == nullptr) return false;
+            if (!BigFixed::parse(*x, job.view.centerx) || !BigFixed::parse(*y, job.view.centery))
+            {
+                std::cerr << "bad center: " << *x << " " << *y << std::endl;
+                return false;
+            }
+            i += 2;
+        }
+        else if (opt == "--zoom")
+        {
+            if (!number(value(1), job.view.zoom)) return false;
+            i++;
+        }
+        else if (opt == "--exponent")
+        {
+            if (!number(value(1), job.view.exponent)) return false;
+            i++;
+        }
+        else if (opt == "--threshhold")
+        {
+            if (!number(value(1), job.view.threshhold)) return false;
+            i++;
+        }
+        else if (opt == "--max-steps")
+        {
+            if (!count(value(1), 1.0, UINT32_MAX, d)) return false;
+            job.view.max_steps = (uint32_t)d;
+            i++;
+        }
+        else if (opt == "--size")
+        {
+            const std::string* text = value(1);
+            if (text == nullptr) return false;
+            int w = 0, h = 0;
+            char x = 0;
+            std::istringstream stream(*text);
+            if (!(stream >> w >> x >> h) || x != 'x' || w <= 0 || h <= 0)
+            {
+                std::cerr << "bad size (want WxH): " << *text << std::endl;
+                return false;
+            }
+            job.view.width = w;
+            job.view.height = h;
+            i++;
+        }
+        else if (opt == "--smooth")
+        {
+            job.smooth = true;
+        }
+        else if (opt == "--frames")
+        {
+            if (!count(value(1), 0.0, INT_MAX, d)) return false;
+            job.frames = (int)d;
+            i++;
+        }
+        else if (opt == "--start-zoom")
+        {
+            if (!number(value(1), job.start_zoom)) return false;
+            i++;
+        }
+        else if (opt == "--output")
+        {
+            const std::string* text = value(1);
+            if (text == nullptr) return false;
+            job.output = *text;
+            i++;
+        }
+        else if (opt == "--jobs" && jobs_file != nullptr)
+        {
+            const std::string* text = value(1);
+            if (text == nullptr) return false;
+            *jobs_file = *text;
+            i++;
+        }
+        else
+        {
+            std::cerr << "unknown option " << opt << "\n\n" << USAGE;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char** argv)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    RenderJob defaults;
+    defaults.view.width = 1280;
+    defaults.view.height = 720;
+
+    std::string jobs_file;
+    if (!parse_options(std::vector<std::string>(argv + 1, argv + argc), defaults, &jobs_file))
+        return 1;
+
+    // the command line is one job, unless a job file lists several
+    std::vector<RenderJob> jobs;
+    if (jobs_file.empty())
+    {
+        jobs.push_back(defaults);
+    }
+    else
+    {
+        std::ifstream file(jobs_file);
+        if (!file)
+        {
+            std::cerr << "could not open job file " << jobs_file << std::endl;
+            return 1;
+        }
+        int line_number = 0;
+        for (std::string line; std::getline(file, line);)
+        {
+            line_number++;
+            const std::vector<std::string> words = split_words(line);
+            if (words.empty()) continue;
+
+            RenderJob job = defaults;
+            if (!parse_options(words, job, nullptr))
+            {
+                std::cerr << "...at " << jobs_file << ":" << line_number << std::endl;
+                return 1;
+            }
+            jobs.push_back(job);
+        }
+    }
+    for (const RenderJob& job : jobs)
+        if (job.output.empty())
+        {
+            std::cerr << "every job needs --output\n\n" << USAGE;
+            return 1;
+        }
+
+    // shared by every job
+    Program::set_binary_cache(SHADER_CACHE_DIR);
+    HeadlessContext context;
+    FractalRenderer fractal;
+    Colorizer colorizer;
+    PosterExport exporter(fractal, colorizer);
+    ZoomVideo video(fractal, colorizer);
+
+    const auto setup_done = std::chrono::steady_clock::now();
+    std::cout << "renderer: " << context.renderer() << ", setup "
+        << std::chrono::duration<double, std::milli>(setup_done - start).count()
+        << "ms" << std::endl;
+
+    int failed = 0;
+    for (const RenderJob& job : jobs)
+    {
+        const auto job_start = std::chrono::steady_clock::now();
+        const View& view = job.view;
+
+        if (job.frames > 0)
+        {
+            if (!video.run(view, job.start_zoom, job.frames, job.smooth, job.output))
+            {
+                failed++;
+                continue;
+            }
+
+            const auto job_end = std::chrono::steady_clock::now();
+            std::cout << "wrote " << job.frames << " frames to " << job.output
+                << " (" << view.width << "x" << view.height
+                << ", " << video.map_width() << "x" << video.map_rows() << " map, "
+                << std::chrono::duration<double, std::milli>(job_end - job_start).count()
+                << "ms)" << std::endl;
+            continue;
+        }
+
+        if (!exporter.run(view, job.smooth, job.output))
+        {
+            failed++;
+            continue;
+        }
+
+        const auto job_end = std::chrono::steady_clock::now();
+        if (exporter.resumed_rows() > 0)
+            std::cout << "resumed " << job.output << " at row " << exporter.resumed_rows() << std::endl;
+        std::cout << "wrote " << job.output
+            << " (" << view.width << "x" << view.height
+            << ", " << fractal_mode_name(fractal.mode_for(view)) << ", "
+            << std::chrono::duration<double, std::milli>(job_end - job_start).count()
+            << "ms)" << std::endl;
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    std::cout << jobs.size() - failed << "/" << jobs.size() << " jobs in "
+        << std::chrono::duration<double, std::milli>(end - setup_done).count()
+        << "ms" << std::endl;
+
+    // the first job waits on whatever was not in the cache
+    const ProgramStats& stats = Program::stats();
+    std::cout << stats.compiled << " programs compiled, " << stats.from_binary
+        << " loaded from " << SHADER_CACHE_DIR << std::endl;
+
+    return failed? 1 : 0;
+}
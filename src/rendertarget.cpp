@@ -4,6 +4,7 @@
 #include <iostream>
 #include <utility>
 
+#include "gl-state.hpp"
 #include "program.hpp"
 #include "vertex-array.hpp"
 
@@ -40,6 +41,7 @@ static inline void setup_program()
         std::filesystem::path{"shaders/texture.vert"},
         std::filesystem::path{"shaders/texture.frag"});
     // link tex sampler2D to slot 0
+    s_texture_program->use();
     glUniform1i(s_texture_program->get_uniform("tex"), 0);
 
     // find unifs for tex transform data
@@ -64,15 +66,27 @@ static inline GLuint generateFBO(void)
     glGenFramebuffers(1, &fbo);
     return fbo;
 }
+// pixel transfer format and type to allocate a color format with
+static inline void get_transfer_format(GLint color_format, GLenum& format, GLenum& type)
+{
+    switch (color_format)
+    {
+        case GL_R32F:  format = GL_RED;         type = GL_FLOAT;        break;
+        case GL_RG32F: format = GL_RG;          type = GL_FLOAT;        break;
+        case GL_R32UI: format = GL_RED_INTEGER; type = GL_UNSIGNED_INT; break;
+        default:       format = GL_RGB;         type = GL_UNSIGNED_BYTE; break;
+    }
+}
+
 // this is the constructor outside classes (other than Screen) will use
-RenderTarget::RenderTarget(int width, int height) :
-    RenderTarget(width, height, generateFBO()) {}
+RenderTarget::RenderTarget(int width, int height, GLint color_format) :
+    RenderTarget(width, height, generateFBO(), color_format) {}
 
 // this is the *actual* constructor
-RenderTarget::RenderTarget(int width, int height, GLuint fbo) :
+RenderTarget::RenderTarget(int width, int height, GLuint fbo, GLint color_format) :
     m_fbo(fbo),
     m_width(width), m_height(height),
-    m_color_texture(GL_RGB),
+    m_color_texture(color_format),
     m_depth_stencil_texture(GL_DEPTH24_STENCIL8)
 {
     setup_program();
@@ -80,10 +94,11 @@ RenderTarget::RenderTarget(int width, int height, GLuint fbo) :
     use();
 
     // set up framebuffer
-    // color texture
+    // color texture, integer textures cannot be filtered
+    const GLint filter = (color_format == GL_R32UI)? GL_NEAREST : GL_LINEAR;
     m_color_texture.use();
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_color_texture.id(), 0);
     // depth/stencil texture
     m_depth_stencil_texture.use();
@@ -100,7 +115,10 @@ RenderTarget::~RenderTarget(void)
 {
     // if this isn't the default framebuffer (fbo 0), delete
     if (m_fbo != 0)
+    {
+        GLState::current().forget_framebuffer(m_fbo);
         glDeleteFramebuffers(1, &m_fbo);
+    }
 }
 
 RenderTarget::RenderTarget(RenderTarget&& rhs) :
@@ -137,9 +155,11 @@ void RenderTarget::resize(int width, int height)
     m_height = height;
     use();
 
+    GLenum color_format = GL_RGB, color_type = GL_UNSIGNED_BYTE;
+    get_transfer_format(m_color_texture.internal_format(), color_format, color_type);
     m_color_texture.set_pixels(
         width, height,
-        GL_RGB, GL_UNSIGNED_BYTE,
+        color_format, color_type,
         NULL);
     m_depth_stencil_texture.set_pixels(
         width, height,
@@ -185,8 +205,8 @@ void RenderTarget::resize(int width, int height)
 
 void RenderTarget::use(void)
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-    glViewport(0, 0, m_width, m_height);
+    GLState::current().bind_framebuffer(GL_FRAMEBUFFER, m_fbo);
+    GLState::current().viewport(0, 0, m_width, m_height);
 }
 
 void RenderTarget::clear(void)
@@ -195,6 +215,15 @@ void RenderTarget::clear(void)
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
 
+void RenderTarget::read_rgb(std::vector<uint8_t>& out)
+{
+    out.resize((std::size_t)m_width * m_height * 3);
+
+    use();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_width, m_height, GL_RGB, GL_UNSIGNED_BYTE, out.data());
+}
+
 
 void RenderTarget::render_texture(
     const Texture& texture,
@@ -205,13 +234,14 @@ void RenderTarget::render_texture(
     this->use();
     s_texture_program->use();
 
-    glEnable(GL_DEPTH_TEST);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState& gl = GLState::current();
+    gl.set_enabled(GL_DEPTH_TEST, true);
+    gl.polygon_mode(GL_FILL);
+    gl.set_enabled(GL_CULL_FACE, false);
+    gl.set_enabled(GL_BLEND, true);
+    gl.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glActiveTexture(GL_TEXTURE0);
+    gl.active_texture(0);
     texture.use();
 
     // set tex transform data
@@ -1,6 +1,9 @@
 #ifndef RENDERTARGETH
 #define RENDERTARGETH
 
+#include <stdint.h>
+#include <vector>
+
 #include <GL/glew.h>
 #include <GL/glu.h>
 
@@ -14,12 +17,14 @@ class RenderTarget
     // m_framebufferID == 0 (so that rendering to it draws to the screen)
     // this will be called from the regular constructor with fbo != 0, and
     // from Screen with fbo == 0
-    RenderTarget(int width, int height, GLuint fbo);
+    RenderTarget(int width, int height, GLuint fbo, GLint color_format);
 
 public:
     // this is the constructor outside classes (other than Screen) will use
+    // color_format may also be a float or integer format (e.x. GL_R32F,
+    // GL_RG32F, GL_R32UI) for targets that store data rather than colors
     RenderTarget(void) = default;
-    RenderTarget(int width, int height);
+    RenderTarget(int width, int height, GLint color_format = GL_RGB);
     ~RenderTarget(void);
 
     RenderTarget(const RenderTarget&) = delete;
@@ -43,7 +48,12 @@ public:
     void use(void);
     void clear(void);
 
-    // render the given texture(s) onto this RenderTarget
+    // copy the color attachment into out as tightly packed 8-bit RGB rows,
+    // bottom row first (GL order)
+    void read_rgb(std::vector<uint8_t>& out);
+
+    // render the given texture(s) onto this RenderTarget; one draw per call,
+    // a QuadBatch draws many quads together
     void render_texture(
         const Texture& texture,
         int x, int y, // position, in screen-space (x=[0,w) and y=[0,h))
@@ -0,0 +1,226 @@
+#include "reprojection.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "gl-state.hpp"
+
+
+Reprojection::Reprojection(int width, int height) :
+    m_targets{ RenderTarget(width, height, GL_RG32F), RenderTarget(width, height, GL_RG32F) }
+{
+    m_view.width = width;
+    m_view.height = height;
+}
+
+
+void Reprojection::update(FractalRenderer& fractal, const View& view, size_t pixel_budget)
+{
+    // only center, zoom and size can be mapped from the previous frame
+    const bool reprojectable = m_valid
+        && bits_equal(view.exponent, m_view.exponent)
+        && bits_equal(view.threshhold, m_view.threshhold)
+        && view.max_steps == m_view.max_steps;
+
+    if (!reprojectable)
+    {
+        // the previous frame previews the new one, if there is one of the
+        // same size
+        const bool preview = m_drawn
+            && view.width == m_view.width && view.height == m_view.height;
+        m_view = view;
+        m_valid = true;
+        m_exposed.clear();
+        m_pending.clear();
+        if (preview)
+        {
+            add_tiles(m_pending, 0, 0, view.width, view.height);
+        }
+        else
+        {
+            m_targets[m_current].resize(view.width, view.height);
+            m_targets[m_current].clear();
+            add_tiles(m_exposed, 0, 0, view.width, view.height);
+        }
+    }
+    else if (!(view == m_view))
+    {
+        reproject(view);
+    }
+
+    draw_tiles(fractal, pixel_budget);
+}
+
+void Reprojection::invalidate(void)
+{
+    m_valid = false;
+}
+
+
+void Reprojection::reproject(const View& view)
+{
+    RenderTarget& src = m_targets[m_current];
+    RenderTarget& dst = m_targets[1 - m_current];
+    const int w = view.width, h = view.height;
+    const int src_w = src.width(), src_h = src.height();
+    dst.resize(w, h);
+
+    // the previous frame's corners in the new frame, in pixels; with d the
+    // center offset in old clip space and s the zoom ratio,
+    //   new = (old - d) * s
+    const double s = view.zoom / m_view.zoom;
+    const double dx = (view.centerx - m_view.centerx).to_double() * m_view.zoom / view.aspect();
+    const double dy = (view.centery - m_view.centery).to_double() * m_view.zoom;
+    const double x0 = ((-1.0 - dx) * s + 1.0) * 0.5 * w;
+    const double x1 = (( 1.0 - dx) * s + 1.0) * 0.5 * w;
+    const double y0 = ((-1.0 - dy) * s + 1.0) * 0.5 * h;
+    const double y1 = (( 1.0 - dy) * s + 1.0) * 0.5 * h;
+
+    // a pan by whole pixels lands every old pixel exactly on a new one
+    const bool exact = w == src_w && h == src_h
+        && bits_equal(view.zoom, m_view.zoom)
+        && std::abs(x0 - std::round(x0)) < 1e-3
+        && std::abs(y0 - std::round(y0)) < 1e-3;
+
+    // part of the new frame the old one covers, and where that comes from
+    int cx0, cy0, cx1, cy1;
+    int sx0, sy0, sx1, sy1;
+    if (exact)
+    {
+        const int ix = (int)std::lround(x0), iy = (int)std::lround(y0);
+        cx0 = std::max(0, ix); cx1 = std::min(w, w + ix);
+        cy0 = std::max(0, iy); cy1 = std::min(h, h + iy);
+        sx0 = cx0 - ix; sx1 = cx1 - ix;
+        sy0 = cy0 - iy; sy1 = cy1 - iy;
+    }
+    else
+    {
+        const double fx0 = std::clamp(x0, 0.0, (double)w), fx1 = std::clamp(x1, 0.0, (double)w);
+        const double fy0 = std::clamp(y0, 0.0, (double)h), fy1 = std::clamp(y1, 0.0, (double)h);
+        cx0 = (int)std::lround(fx0); cx1 = (int)std::lround(fx1);
+        cy0 = (int)std::lround(fy0); cy1 = (int)std::lround(fy1);
+        sx0 = (int)std::lround((fx0 - x0) / (x1 - x0) * src_w);
+        sx1 = (int)std::lround((fx1 - x0) / (x1 - x0) * src_w);
+        sy0 = (int)std::lround((fy0 - y0) / (y1 - y0) * src_h);
+        sy1 = (int)std::lround((fy1 - y0) / (y1 - y0) * src_h);
+    }
+
+    // tiles below are clipped to the new frame
+    m_view = view;
+
+    dst.clear();
+    std::vector<Tile> old_exposed = std::move(m_exposed);
+    std::vector<Tile> old_pending = std::move(m_pending);
+    m_exposed.clear();
+    m_pending.clear();
+
+    if (cx1 <= cx0 || cy1 <= cy0 || sx1 <= sx0 || sy1 <= sy0)
+    {
+        // nothing in common
+        add_tiles(m_exposed, 0, 0, w, h);
+    }
+    else
+    {
+        GLState::current().bind_framebuffer(GL_READ_FRAMEBUFFER, src.fbo());
+        GLState::current().bind_framebuffer(GL_DRAW_FRAMEBUFFER, dst.fbo());
+        glBlitFramebuffer(
+            sx0, sy0, sx1, sy1,
+            cx0, cy0, cx1, cy1,
+            GL_COLOR_BUFFER_BIT, exact? GL_NEAREST : GL_LINEAR);
+        dst.use();
+
+        // everything around the covered rect is new
+        add_tiles(m_exposed, 0, 0, cx0, h);
+        add_tiles(m_exposed, cx1, 0, w - cx1, h);
+        add_tiles(m_exposed, cx0, 0, cx1 - cx0, cy0);
+        add_tiles(m_exposed, cx0, cy1, cx1 - cx0, h - cy1);
+
+        if (exact)
+        {
+            // copied pixels are final, apart from those still exposed or
+            // pending
+            const int ix = cx0 - sx0, iy = cy0 - sy0;
+            for (const Tile& tile : old_exposed)
+                add_tiles(m_exposed, tile.x + ix, tile.y + iy, tile.width, tile.height);
+            for (const Tile& tile : old_pending)
+                add_tiles(m_pending, tile.x + ix, tile.y + iy, tile.width, tile.height);
+        }
+        else
+        {
+            add_tiles(m_pending, cx0, cy0, cx1 - cx0, cy1 - cy0);
+        }
+    }
+
+    m_current = 1 - m_current;
+}
+
+void Reprojection::add_tiles(std::vector<Tile>& tiles, int x, int y, int width, int height) const
+{
+    // clip to the frame
+    const int x1 = std::min(x + width, m_view.width);
+    const int y1 = std::min(y + height, m_view.height);
+    x = std::max(x, 0);
+    y = std::max(y, 0);
+
+    for (int ty = y; ty < y1; ty += TILE_SIZE)
+        for (int tx = x; tx < x1; tx += TILE_SIZE)
+        {
+            Tile tile;
+            tile.x = tx;
+            tile.y = ty;
+            tile.width = std::min(TILE_SIZE, x1 - tx);
+            tile.height = std::min(TILE_SIZE, y1 - ty);
+            tiles.push_back(tile);
+        }
+}
+
+void Reprojection::draw_tiles(FractalRenderer& fractal, size_t pixel_budget)
+{
+    if (complete()) return;
+
+    // nearest to the center last, so they pop first
+    const double midx = 0.5 * m_view.width, midy = 0.5 * m_view.height;
+    const auto distance = [&](const Tile& t)
+    {
+        const double x = t.x + 0.5 * t.width - midx;
+        const double y = t.y + 0.5 * t.height - midy;
+        return x*x + y*y;
+    };
+    const auto by_distance = [&](const Tile& a, const Tile& b) { return distance(a) > distance(b); };
+    std::sort(m_exposed.begin(), m_exposed.end(), by_distance);
+    std::sort(m_pending.begin(), m_pending.end(), by_distance);
+
+    RenderTarget& target = m_targets[m_current];
+    const bool cached = mp_cache && mp_cache->covers(fractal, m_view);
+
+    // cached tiles are copied and cost nothing; always make some progress,
+    // even on a tiny budget
+    size_t spent = 0;
+    const auto draw_some = [&](std::vector<Tile>& tiles)
+    {
+        while (!tiles.empty())
+        {
+            const Tile& tile = tiles.back();
+            if (!(cached && mp_cache->draw(fractal, m_view, target, tile)))
+            {
+                const size_t pixels = (size_t)tile.width * tile.height;
+                if (spent > 0 && spent + pixels > pixel_budget) return;
+
+                target.use();
+                GLState::current().set_enabled(GL_SCISSOR_TEST, true);
+                glScissor(tile.x, tile.y, tile.width, tile.height);
+                fractal.draw(m_view);
+                spent += pixels;
+            }
+            tiles.pop_back();
+        }
+    };
+    draw_some(m_exposed);
+    draw_some(m_pending);
+
+    GLState::current().set_enabled(GL_SCISSOR_TEST, false);
+    m_drawn = true;
+
+    if (cached && complete())
+        mp_cache->store(fractal, m_view, target);
+}
@@ -0,0 +1,79 @@
+#ifndef REPROJECTIONH
+#define REPROJECTIONH
+
+#include <stddef.h>
+#include <vector>
+
+#include "fractal-renderer.hpp"
+#include "rendertarget.hpp"
+#include "tile-cache.hpp"
+#include "tile-scheduler.hpp"
+#include "view.hpp"
+
+
+// keeps the fractal's iteration counts for a View (RG32F, see
+// FractalRenderer), reusing the previous frame when only
+// the center or zoom changed
+//
+// whole-pixel pans copy the previous frame and only iterate the strips that
+// were exposed; zooms, fractional pans and size changes stretch the previous
+// frame as a preview, then iterate the real frame back in over the next few
+// updates, center tiles first. other changes keep the previous frame as the
+// preview. tiles a TileCache has are copied from it instead of iterated, and
+// every complete frame is added to it
+class Reprojection
+{
+public:
+    // size of the tiles recomputed one scissored draw at a time
+    constexpr static int TILE_SIZE = 128;
+
+    Reprojection(int width, int height);
+
+public:
+    // bring the frame towards view, iterating at most pixel_budget pixels
+    void update(FractalRenderer& fractal, const View& view, size_t pixel_budget);
+
+    // force a full redraw on the next update, for changes View does not track
+    void invalidate(void);
+
+    // copy pixels from cached tiles where it has them, and keep complete
+    // frames there, or nullptr to always iterate them
+    void set_tile_cache(TileCache* cache) { mp_cache = cache; }
+
+    // true once the frame is exact for the last updated view
+    bool complete(void) const
+    {
+        return m_valid && m_exposed.empty() && m_pending.empty();
+    }
+
+    const Texture& iterations(void) const { return m_targets[m_current].color_texture(); }
+
+private:
+    // copy or stretch the current frame into the other target, mapped from
+    // m_view to view, then make that the current one
+    void reproject(const View& view);
+
+    // split a rect into tiles, clipped to the frame
+    void add_tiles(std::vector<Tile>& tiles, int x, int y, int width, int height) const;
+
+    // iterate exposed tiles and then pending tiles, nearest to the center
+    // first, until the budget runs out
+    void draw_tiles(FractalRenderer& fractal, size_t pixel_budget);
+
+private:
+    RenderTarget m_targets[2];
+    int m_current = 0;
+
+    // what m_targets[m_current] shows, apart from the exposed and pending
+    // tiles; drawn once it has held any frame, to preview the next one
+    View m_view;
+    bool m_valid = false;
+    bool m_drawn = false;
+
+    // exposed tiles hold nothing yet, pending tiles hold a preview
+    std::vector<Tile> m_exposed, m_pending;
+
+    TileCache* mp_cache = nullptr;
+};
+
+#endif // REPROJECTIONH
@@ -0,0 +1,62 @@
+#include "resolution-scaler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+ResolutionScaler::ResolutionScaler(double budget_ms) :
+    m_budget_ms(budget_ms)
+{
+}
+
+
+void ResolutionScaler::update(bool moving, const TimingStats& gpu)
+{
+    if (gpu.count() != m_samples_seen)
+    {
+        m_samples_seen = gpu.count();
+
+        // a short moving average, clamped so one stall (a shader compile,
+        // say) does not hold the scale down for long
+        const double ms = std::min(gpu.last(), 4.0 * m_budget_ms);
+        m_frame_ms = (m_frame_ms > 0.0)? 0.75 * m_frame_ms + 0.25 * ms : ms;
+    }
+
+    if (!moving)
+    {
+        m_level = 0;
+        m_settle = 0;
+        return;
+    }
+
+    if (m_settle > 0)
+    {
+        m_settle--;
+        return;
+    }
+
+    // iteration time goes with the pixel count, the square of the scale
+    if (m_frame_ms > m_budget_ms && m_level + 1 < LEVEL_COUNT)
+    {
+        m_level++;
+        m_settle = SETTLE_FRAMES;
+    }
+    else if (m_level > 0)
+    {
+        const double up = LEVELS[m_level - 1] / LEVELS[m_level];
+        if (m_frame_ms * up * up < 0.8 * m_budget_ms)
+        {
+            m_level--;
+            m_settle = SETTLE_FRAMES;
+        }
+    }
+}
+
+
+View ResolutionScaler::scaled(const View& view) const
+{
+    View out = view;
+    out.width = std::max(1, (int)std::lround(view.width * scale()));
+    out.height = std::max(1, (int)std::lround(view.height * scale()));
+    return out;
+}
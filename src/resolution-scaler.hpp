@@ -0,0 +1,56 @@
+#ifndef RESOLUTIONSCALERH
+#define RESOLUTIONSCALERH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "frame-profiler.hpp"
+#include "view.hpp"
+
+
+// picks the internal resolution the fractal is iterated at, from how long
+// the gpu took on recent frames
+//
+// while the view moves the scale steps down whenever frames go over budget,
+// and back up once there is room for the next level; once it stops, the
+// scale returns to full and Reprojection refines the stretched frame back in
+// over a few updates. levels are coarse and changes rate limited, since every
+// size change turns exact pans into stretches
+class ResolutionScaler
+{
+public:
+    // fraction of the screen's width and height, largest first
+    constexpr static double LEVELS[] = { 1.0, 0.75, 0.5, 0.375, 0.25 };
+    constexpr static size_t LEVEL_COUNT = sizeof(LEVELS) / sizeof(LEVELS[0]);
+
+    // frames a new level is kept before the next change, so the timings
+    // reflect it
+    constexpr static int SETTLE_FRAMES = 8;
+
+    // budget_ms: gpu time per frame for iterating the fractal
+    explicit ResolutionScaler(double budget_ms);
+
+public:
+    // take the newest of gpu's timings of iterating the fractal, and pick
+    // the level for the next frame
+    void update(bool moving, const TimingStats& gpu);
+
+    double scale(void) const { return LEVELS[m_level]; }
+    bool full(void) const { return m_level == 0; }
+    // smoothed gpu time of the timed work, in milliseconds
+    double frame_ms(void) const { return m_frame_ms; }
+
+    // view at the current scale, the same region of the plane
+    View scaled(const View& view) const;
+
+private:
+    // timings already taken
+    uint64_t m_samples_seen = 0;
+
+    double m_budget_ms = 0.0;
+    double m_frame_ms = 0.0;
+    size_t m_level = 0;
+    int m_settle = 0;
+};
+
+#endif // RESOLUTIONSCALERH
@@ -1,5 +1,6 @@
 #include "screen.hpp"
 
+#include <stdio.h>
 #include <iostream>
 
 
@@ -76,14 +77,14 @@ Screen::Screen(uint32_t width, uint32_t height, const char* title) :
 
     // enable Vsync
     if (SDL_GL_SetSwapInterval(1) < 0)
-        printf("warning: could not enable vsync\nSDL error: %s\n", SDL_GetError());
+        fprintf(stderr, "warning: could not enable vsync\nSDL error: %s\n", SDL_GetError());
 
     // // disable Vsync
     // if (SDL_GL_SetSwapInterval(0) < 0)
-    //     printf("warning: could not disable vsync\nSDL error: %s\n", SDL_GetError());
+    //     fprintf(stderr, "warning: could not disable vsync\nSDL error: %s\n", SDL_GetError());
 
     // set up rendertarget
-    m_rendertarget = RenderTarget(width, height, 0);
+    m_rendertarget = RenderTarget(width, height, 0, GL_RGB);
 
     // set up state flags
     m_flags = 0
@@ -164,7 +165,7 @@ bool Screen::process_event(SDL_Event& e)
     // quit event
     if (e.type == SDL_QUIT)
     {
-        printf("screen: quit event received\n");
+        fprintf(stderr, "screen: quit event received\n");
         return false;
     }
 
@@ -174,7 +175,7 @@ bool Screen::process_event(SDL_Event& e)
         // is this our event?
         if (e.window.windowID != m_windowID)
         {
-            printf("screen: event not for this window (for %d, we are %d)\n", e.window.windowID, m_windowID);
+            fprintf(stderr, "screen: event not for this window (for %d, we are %d)\n", e.window.windowID, m_windowID);
             return true;
         }
 
@@ -199,9 +200,10 @@ bool Screen::process_event(SDL_Event& e)
             // window has been hidden/exposed
             case SDL_WINDOWEVENT_SHOWN:
                 setFlag(WindowFlag::Shown);
-                [[fallthrough]];
+                break;
+            // redrawn by whoever draws to the window, whose thread the
+            // context may be current on
             case SDL_WINDOWEVENT_EXPOSED:
-                SDL_GL_SwapWindow(mp_window);
                 break;
             case SDL_WINDOWEVENT_HIDDEN:
                 clearFlag(WindowFlag::Shown);
@@ -1,10 +1,13 @@
 #include "text.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <string>
 #include <vector>
 
+#include "gl-state.hpp"
+
 
 // error checking for SDL_ttf calls
 #define checkTTFError(val) _checkTTFError( (val), #val, __FILE__, __LINE__ )
@@ -26,15 +29,84 @@ void _checkTTFError(
 
 namespace {
 static std::size_t sg_TTF_INIT_COUNT = 0;
+
+// atlas rows are this wide, a multiple of 4 so rows need no padding for GL
+constexpr static int ATLAS_WIDTH = 512;
 }
 
-Font::Font(std::filesystem::path path, int fontsize)
+Font::Font(std::filesystem::path path, int fontsize) :
+    m_atlas(GL_R8),
+    m_prog(
+        std::filesystem::path{"shaders/text.vert"},
+        std::filesystem::path{"shaders/text.frag"})
 {
     if (sg_TTF_INIT_COUNT++ == 0)
         checkTTFError(TTF_Init() == -1); // -1 on error
 
     mp_font = TTF_OpenFont(path.c_str(), fontsize);
     checkTTFError(mp_font == NULL);
+
+    // rasterize every character once, as a cell as wide as its advance and
+    // as tall as a line, so a string's cells tile into one shaded block
+    std::vector<SDL_Surface*> surfs;
+    int x = 0, y = 0;
+    for (char c = FIRST_CHAR; c <= LAST_CHAR; c++)
+    {
+        const char str[2] = {c, '\0'};
+        SDL_Surface* surf = TTF_RenderUTF8_Shaded(
+            mp_font, str,
+            SDL_Color{255,255,255,255}, SDL_Color{0,0,0,255});
+        checkTTFError(surf == NULL);
+        surfs.push_back(surf);
+
+        m_line_height = std::max(m_line_height, surf->h);
+        if (x + surf->w > ATLAS_WIDTH)
+        {
+            x = 0;
+            y += m_line_height;
+        }
+        Glyph& glyph = m_glyphs[c - FIRST_CHAR];
+        glyph.x = x;
+        glyph.y = y;
+        glyph.width = surf->w;
+        x += surf->w;
+    }
+    const int atlas_height = y + m_line_height;
+
+    // atlas rows top-down, so v grows down the glyph like y on screen
+    std::vector<unsigned char> pixels((std::size_t)ATLAS_WIDTH * atlas_height, 0);
+    for (char c = FIRST_CHAR; c <= LAST_CHAR; c++)
+    {
+        SDL_Surface* surf = surfs[c - FIRST_CHAR];
+        const Glyph& glyph = m_glyphs[c - FIRST_CHAR];
+        SDL_LockSurface(surf);
+        const unsigned char* surf_pixels = (const unsigned char*)surf->pixels;
+        for (int sy = 0; sy < surf->h; sy++)
+            std::copy(
+                surf_pixels + (std::size_t)sy * surf->pitch,
+                surf_pixels + (std::size_t)sy * surf->pitch + surf->w,
+                pixels.begin() + (std::size_t)(glyph.y + sy) * ATLAS_WIDTH + glyph.x);
+        SDL_UnlockSurface(surf);
+        SDL_FreeSurface(surf);
+    }
+
+    m_atlas.set_pixels(ATLAS_WIDTH, atlas_height, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // no per-vertex data: corners come from gl_VertexID, every attribute
+    // is per quad
+    m_vao.add_vertex_buffer(sizeof(GlyphInstance), 1);
+    auto& vbo = m_vao.get_buffer(0);
+    vbo.add_attrib(4, GL_FLOAT); // vec4 v_rect
+    vbo.add_attrib(4, GL_FLOAT); // vec4 v_texrect
+
+    m_unif_screen_size = m_prog.get_uniform("screen_size");
+    m_unif_z = m_prog.get_uniform("z");
+
+    // atlas sampler reads from slot 0
+    m_prog.use();
+    glUniform1i(m_prog.get_uniform("atlas"), 0);
 }
 
 Font::~Font(void)
@@ -47,60 +119,69 @@ Font::~Font(void)
         TTF_Quit();
 }
 
-Texture Font::render_text_fast_bitmap(std::string_view text, GLuint texture_fmt)
+
+const Font::Glyph& Font::glyph(char c) const
 {
-    // string_view has no null termination
-    std::string text_str(text);
-
-    SDL_Surface* surf = TTF_RenderUTF8_Shaded(
-        mp_font,
-        text_str.c_str(),
-        SDL_Color{255,255,255,255}, SDL_Color{0,0,0,255});
-    checkTTFError(surf == NULL);
-    SDL_LockSurface(surf);
-
-    int w = surf->w, h = surf->h, surf_pitch = surf->pitch;
-
-    // this step:
-    //   - removes pitch, since GL cannot use pitch != width
-    //   - pads rows to 4-byte alignment for GL (without glPixelStorei)
-    //   - flips image y
-    int pitch = (w % 4)? ((w/4 + 1) * 4) : w;
-    std::vector<unsigned char> pixels(pitch * h);
-    unsigned char* surf_pixels = (unsigned char*)surf->pixels;
-    for (int y = 0; y < h; y++)
+    if (c < FIRST_CHAR || c > LAST_CHAR) c = '?';
+    return m_glyphs[c - FIRST_CHAR];
+}
+
+int Font::text_width(std::string_view text) const
+{
+    int width = 0;
+    for (char c : text)
+        width += glyph(c).width;
+    return width;
+}
+
+void Font::add_text(std::string_view text, int x, int y)
+{
+    const float atlas_width = (float)m_atlas.width();
+    const float atlas_height = (float)m_atlas.height();
+    for (char c : text)
     {
-        int surf_y = h - y - 1;
-        for (int x = 0; x < w; x++)
-        {
-            unsigned long pi = (unsigned long)y * pitch + x;
-            unsigned long spi = (unsigned long)surf_y * surf_pitch + x;
-            pixels[pi] = surf_pixels[spi];
-        }
+        const Glyph& g = glyph(c);
+        m_instances.push_back(GlyphInstance{
+            (float)x, (float)y, (float)g.width, (float)m_line_height,
+            g.x / atlas_width, g.y / atlas_height,
+            g.width / atlas_width, m_line_height / atlas_height});
+        x += g.width;
     }
+}
 
-    SDL_FreeSurface(surf);
+void Font::draw(RenderTarget& target, float z)
+{
+    if (m_instances.empty()) return;
+    const GLsizei count = (GLsizei)m_instances.size();
 
-    Texture tex(texture_fmt);
-    tex.set_pixels(w, h, GL_RED, GL_UNSIGNED_BYTE, &pixels[0]);
-    return tex;
-}
+    target.use();
+    m_prog.use();
 
+    GLState& gl = GLState::current();
+    gl.set_enabled(GL_DEPTH_TEST, true);
+    gl.polygon_mode(GL_FILL);
+    gl.set_enabled(GL_CULL_FACE, false);
+    gl.set_enabled(GL_BLEND, true);
+    gl.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-/*
-{
-    if ((surf != NULL) && (surf->w > 0) && (surf->h > 0))
+    gl.active_texture(0);
+    m_atlas.use();
+
+    glUniform2i(m_unif_screen_size, target.width(), target.height());
+    glUniform1f(m_unif_z, z);
+
+    // grow the buffer only when more text is queued than ever before
+    m_vao.use();
+    auto& vbo = m_vao.get_buffer(0);
+    if (count > m_capacity)
     {
-        SDL_LockSurface(surf);
-        Uint8* const pixels = (Uint8*)surf->pixels;
-        // blit each pixel to screen
-        for (int32_t dy = 0; dy < surf->h; dy++)
-            for (int32_t dx = 0; dx < surf->w; dx++)
-                if (pixels[dy * surf->pitch + dx])
-                    pixel(x+dx, y+dy, c);
-        SDL_UnlockSurface(surf);
+        m_capacity = std::max(count, 2 * m_capacity);
+        vbo.bind_data(nullptr, m_capacity, GL_STREAM_DRAW);
     }
-    // safe to call SDL_FreeSurface with NULL
-    SDL_FreeSurface(surf);
+    vbo.update_data(m_instances.data(), count);
+
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
+
+    // keeps its capacity, so later frames do not allocate
+    m_instances.clear();
 }
-*/
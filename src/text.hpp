@@ -3,26 +3,81 @@
 
 #include <string_view>
 #include <filesystem>
+#include <vector>
 
 #include <GL/glew.h>
 #include <GL/gl.h>
 #include <SDL_ttf.h>
 
 #include "program.hpp"
+#include "rendertarget.hpp"
 #include "texture.hpp"
+#include "vertex-array.hpp"
 
 
+// draws text from a glyph atlas, rasterized once when the font is opened
+//
+// strings are queued with add_text() and drawn together by draw(), as one
+// instanced quad per character, so text costs no rasterization, texture
+// uploads or allocations per frame. characters are printable ASCII, anything
+// else draws as '?'. drawn as white on black, like TTF_RenderUTF8_Shaded
 class Font
 {
 public:
+    // characters in the atlas
+    constexpr static char FIRST_CHAR = ' ';
+    constexpr static char LAST_CHAR = '~';
+
     Font(std::filesystem::path path, int fontsize);
     ~Font(void);
 
+    Font(const Font&) = delete;
+    Font& operator=(const Font&) = delete;
+
 public:
-    Texture render_text_fast_bitmap(std::string_view text, GLuint fmt);
+    // size of text in pixels, as add_text() would draw it
+    int text_width(std::string_view text) const;
+    int line_height(void) const { return m_line_height; }
+
+    // queue text with its top left corner at (x, y), in pixels from the top
+    // left of the target
+    void add_text(std::string_view text, int x, int y);
+
+    // draw everything queued onto target, at depth z (in clip-space), and
+    // empty the queue
+    void draw(RenderTarget& target, float z);
+
+private:
+    struct Glyph
+    {
+        // cell in the atlas, in texels
+        int x = 0, y = 0;
+        int width = 0;
+    };
+
+    // one quad, in the layout of shaders/text.vert's per-instance attributes
+    struct GlyphInstance
+    {
+        float x, y, width, height; // on the target, in pixels
+        float u, v, du, dv;        // in the atlas, normalized
+    };
+
+    const Glyph& glyph(char c) const;
 
 private:
     TTF_Font* mp_font = nullptr;
+
+    Texture m_atlas;
+    Glyph m_glyphs[LAST_CHAR - FIRST_CHAR + 1];
+    int m_line_height = 0;
+
+    // queued quads, and how many the instance buffer has room for
+    std::vector<GlyphInstance> m_instances;
+    GLsizei m_capacity = 0;
+
+    VertexArray m_vao;
+    Program m_prog;
+    GLint m_unif_screen_size = -1, m_unif_z = -1;
 };
 
 #endif // TEXTH
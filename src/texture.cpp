@@ -3,6 +3,8 @@
 #include <iostream>
 #include <utility>
 
+#include "gl-state.hpp"
+
 
 static inline GLuint generate_texture_id(void)
 {
@@ -19,7 +21,10 @@ Texture::Texture(GLint internal_format) :
 Texture::~Texture(void)
 {
     if (m_id != 0)
+    {
+        GLState::current().forget_texture(m_id);
         glDeleteTextures(1, &m_id);
+    }
 }
 
 
@@ -41,7 +46,7 @@ Texture& Texture::operator=(Texture&& rhs)
 
 void Texture::use(void) const
 {
-    glBindTexture(GL_TEXTURE_2D, m_id);
+    GLState::current().bind_texture(m_id);
 }
 
 void Texture::generate_mipmap(void)
@@ -0,0 +1,252 @@
+#include "tile-cache.hpp"
+
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "gl-state.hpp"
+
+
+namespace {
+
+static inline uint64_t double_bits(double value)
+{
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// rounds down for negative a too
+static inline int64_t floor_div(int64_t a, int64_t b)
+{
+    return (a >= 0)? a / b : -((-a + b - 1) / b);
+}
+
+// the part of a tile's pixels that [x0, x1) x [y0, y1) of the grid covers
+static inline Tile tile_part(const TileKey& key, int64_t x0, int64_t y0, int64_t x1, int64_t y1)
+{
+    const int64_t tx = key.x * TileCache::TILE_SIZE, ty = key.y * TileCache::TILE_SIZE;
+    Tile part;
+    part.x = (int)(std::max(x0, tx) - tx);
+    part.y = (int)(std::max(y0, ty) - ty);
+    part.width = (int)(std::min(x1, tx + TileCache::TILE_SIZE) - tx) - part.x;
+    part.height = (int)(std::min(y1, ty + TileCache::TILE_SIZE) - ty) - part.y;
+    return part;
+}
+
+static inline bool contains(const Tile& outer, const Tile& inner)
+{
+    return inner.x >= outer.x && inner.y >= outer.y
+        && inner.x + inner.width <= outer.x + outer.width
+        && inner.y + inner.height <= outer.y + outer.height;
+}
+
+} // anonymous namespace
+
+
+bool TileKey::operator==(const TileKey& rhs) const
+{
+    return bits_equal(pixel, rhs.pixel)
+        && phase_x == rhs.phase_x && phase_y == rhs.phase_y
+        && x == rhs.x && y == rhs.y
+        && bits_equal(exponent, rhs.exponent)
+        && bits_equal(threshhold, rhs.threshhold)
+        && max_steps == rhs.max_steps
+        && mode == rhs.mode && bla == rhs.bla
+        && interior == rhs.interior;
+}
+
+size_t TileKeyHash::operator()(const TileKey& key) const
+{
+    // boost::hash_combine
+    size_t seed = 0;
+    const auto combine = [&](uint64_t value)
+    {
+        seed ^= std::hash<uint64_t>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    };
+    combine(double_bits(key.pixel));
+    combine((uint64_t)key.phase_x);
+    combine((uint64_t)key.phase_y);
+    combine((uint64_t)key.x);
+    combine((uint64_t)key.y);
+    combine(double_bits(key.exponent));
+    combine(double_bits(key.threshhold));
+    combine(key.max_steps);
+    combine((uint64_t)key.mode);
+    combine((uint64_t)key.bla);
+    combine((uint64_t)key.interior);
+    return seed;
+}
+
+
+TileCache::TileCache(size_t max_bytes) :
+    m_max_bytes(max_bytes)
+{}
+
+
+bool TileCache::grid_for(
+    const FractalRenderer& fractal, const View& view,
+    TileKey& key, int64_t& gx, int64_t& gy) const
+{
+    if (fractal.mode_for(view) == FractalMode::Perturbation) return false;
+
+    // the frame's bottom left corner, in pixels from the origin
+    const double pixel = 2.0 / (view.zoom * view.height);
+    const double ex = view.centerx.to_double() / pixel - 0.5 * view.width;
+    const double ey = view.centery.to_double() / pixel - 0.5 * view.height;
+    if (!(std::abs(ex) < MAX_PIXELS && std::abs(ey) < MAX_PIXELS)) return false;
+
+    // whole grid pixels, and the offset of the grid left over
+    const auto split = [](double e, int64_t& g, int& phase)
+    {
+        g = (int64_t)std::floor(e);
+        phase = (int)std::lround((e - (double)g) * PHASES);
+        if (phase == PHASES)
+        {
+            g++;
+            phase = 0;
+        }
+    };
+    split(ex, gx, key.phase_x);
+    split(ey, gy, key.phase_y);
+
+    key.pixel = pixel;
+    key.exponent = view.exponent;
+    key.threshhold = view.threshhold;
+    key.max_steps = view.max_steps;
+    key.mode = fractal.mode_for(view);
+    key.bla = fractal.bla_enabled();
+    key.interior = fractal.interior_test();
+    return true;
+}
+
+bool TileCache::covers(const FractalRenderer& fractal, const View& view) const
+{
+    TileKey key;
+    int64_t gx = 0, gy = 0;
+    return grid_for(fractal, view, key, gx, gy);
+}
+
+
+bool TileCache::draw(const FractalRenderer& fractal, const View& view, RenderTarget& target, const Tile& rect)
+{
+    TileKey key;
+    int64_t gx = 0, gy = 0;
+    if (!grid_for(fractal, view, key, gx, gy)) return false;
+
+    // the rect's grid pixels are [gx + rect.x, gx + rect.x + rect.width)
+    const int64_t tx0 = floor_div(gx + rect.x, TILE_SIZE);
+    const int64_t tx1 = floor_div(gx + rect.x + rect.width - 1, TILE_SIZE);
+    const int64_t ty0 = floor_div(gy + rect.y, TILE_SIZE);
+    const int64_t ty1 = floor_div(gy + rect.y + rect.height - 1, TILE_SIZE);
+    std::vector<std::pair<TileKey, const Texture*>> tiles;
+    for (key.y = ty0; key.y <= ty1; key.y++)
+        for (key.x = tx0; key.x <= tx1; key.x++)
+        {
+            const Entry* entry = find(key);
+            const Tile part = tile_part(key,
+                gx + rect.x, gy + rect.y, gx + rect.x + rect.width, gy + rect.y + rect.height);
+            if (entry == nullptr || !contains(entry->valid, part))
+            {
+                m_misses++;
+                return false;
+            }
+            tiles.emplace_back(key, &entry->texture);
+        }
+
+    // tile corners in whole pixels of the frame, y down from the top as the
+    // batch takes them, so every texel lands on a pixel of its own
+    for (const auto& [tile, texture] : tiles)
+    {
+        const int64_t px = tile.x * TILE_SIZE - gx;
+        const int64_t py = tile.y * TILE_SIZE - gy;
+        m_batch.add(*texture,
+            (float)px, (float)(view.height - py - TILE_SIZE),
+            (float)TILE_SIZE, (float)TILE_SIZE, 0.0f);
+    }
+
+    GLState::current().set_enabled(GL_SCISSOR_TEST, true);
+    glScissor(rect.x, rect.y, rect.width, rect.height);
+    m_batch.draw(target, QuadBatch::Mode::Copy);
+    m_hits++;
+    return true;
+}
+
+void TileCache::store(const FractalRenderer& fractal, const View& view, const RenderTarget& target)
+{
+    TileKey key;
+    int64_t gx = 0, gy = 0;
+    if (!grid_for(fractal, view, key, gx, gy) || m_max_bytes < TILE_BYTES) return;
+
+    // every tile the frame touches, and the part of it the frame covers
+    const int64_t tx0 = floor_div(gx, TILE_SIZE), tx1 = floor_div(gx + view.width - 1, TILE_SIZE);
+    const int64_t ty0 = floor_div(gy, TILE_SIZE), ty1 = floor_div(gy + view.height - 1, TILE_SIZE);
+
+    GLState::current().bind_framebuffer(GL_READ_FRAMEBUFFER, target.fbo());
+    for (key.y = ty0; key.y <= ty1; key.y++)
+        for (key.x = tx0; key.x <= tx1; key.x++)
+        {
+            const Tile part = tile_part(key, gx, gy, gx + view.width, gy + view.height);
+
+            // a tile already holding that part is kept as it is, one
+            // holding less is copied again
+            Entry* entry = find(key);
+            if (entry != nullptr && contains(entry->valid, part)) continue;
+            if (entry == nullptr)
+            {
+                // at the cap, the least recently used tile's texture is reused
+                Texture texture;
+                if (bytes() + TILE_BYTES > m_max_bytes)
+                {
+                    texture = std::move(m_lru.back().texture);
+                    m_index.erase(m_lru.back().key);
+                    m_lru.pop_back();
+                    m_evictions++;
+                }
+                else
+                {
+                    texture = Texture(GL_RG32F);
+                    texture.set_pixels(TILE_SIZE, TILE_SIZE, GL_RG, GL_FLOAT, NULL);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                }
+                m_lru.push_front(Entry{ key, std::move(texture), Tile{} });
+                m_index[key] = m_lru.begin();
+                entry = &m_lru.front();
+            }
+
+            entry->texture.use();
+            glCopyTexSubImage2D(GL_TEXTURE_2D, 0, part.x, part.y,
+                (GLint)(key.x * TILE_SIZE - gx) + part.x, (GLint)(key.y * TILE_SIZE - gy) + part.y,
+                part.width, part.height);
+            entry->valid = part;
+        }
+}
+
+void TileCache::set_max_bytes(size_t max_bytes)
+{
+    m_max_bytes = max_bytes;
+    evict();
+}
+
+
+TileCache::Entry* TileCache::find(const TileKey& key)
+{
+    auto it = m_index.find(key);
+    if (it == m_index.end()) return nullptr;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return &*it->second;
+}
+
+void TileCache::evict(void)
+{
+    while (bytes() > m_max_bytes && !m_lru.empty())
+    {
+        m_index.erase(m_lru.back().key);
+        m_lru.pop_back();
+        m_evictions++;
+    }
+}
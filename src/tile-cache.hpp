@@ -0,0 +1,129 @@
+#ifndef TILECACHEH
+#define TILECACHEH
+
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <unordered_map>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include "fractal-renderer.hpp"
+#include "quad-batch.hpp"
+#include "rendertarget.hpp"
+#include "texture.hpp"
+#include "tile-scheduler.hpp"
+#include "view.hpp"
+
+
+// a square of the pixel grid of one pixel size: grid pixel (i, j) covers
+// ((i + phase_x / PHASES) * pixel, (j + phase_y / PHASES) * pixel) and one
+// pixel on, and tile (x, y) holds the grid pixels from
+// (x * TILE_SIZE, y * TILE_SIZE)
+struct TileKey
+{
+    double pixel = 0.0;
+    int phase_x = 0, phase_y = 0;
+    int64_t x = 0, y = 0;
+
+    // everything else that changes the iteration counts: the view's escape
+    // parameters, and how the renderer iterates them
+    double exponent = 2.0;
+    double threshhold = 2.0;
+    uint32_t max_steps = 0;
+    FractalMode mode = FractalMode::Float;
+    bool bla = false;
+    InteriorTest interior = InteriorTest::Off;
+
+    bool operator==(const TileKey& rhs) const;
+};
+
+struct TileKeyHash
+{
+    size_t operator()(const TileKey& key) const;
+};
+
+
+// iteration counts of frames seen before, least recently used dropped first
+// once the memory cap is reached
+//
+// complete frames are cut into tiles on a grid of their own pixels (the
+// tiles on the frame's edges keep the part it covered), so a tile only fits
+// views with the same pixel size and sub-pixel offset, which whole-pixel pans
+// keep: panning back over ground seen at the same zoom, or going back to a
+// view, copies those pixels exactly instead of iterating them again. the cache never iterates anything itself, a rect with a tile
+// missing is left to the caller; views past double precision (perturbation)
+// are not cached
+class TileCache
+{
+public:
+    constexpr static int TILE_SIZE = 128;
+    // sub-pixel offsets a grid is told apart by, finer than the 1e-3 pixel
+    // Reprojection takes a pan as exact at
+    constexpr static int PHASES = 1024;
+    // grid positions past this lose the sub-pixel offset to rounding
+    constexpr static double MAX_PIXELS = 68719476736.0; // 2^36
+
+    // RG32F texels
+    constexpr static size_t TILE_BYTES = (size_t)TILE_SIZE * TILE_SIZE * 2 * sizeof(float);
+
+    explicit TileCache(size_t max_bytes);
+
+public:
+    // true if view's frames can be cached
+    bool covers(const FractalRenderer& fractal, const View& view) const;
+
+    // compose the pixels in rect of the frame for view into target, if
+    // every tile they need is cached; false (and nothing drawn) if not
+    bool draw(const FractalRenderer& fractal, const View& view, RenderTarget& target, const Tile& rect);
+
+    // keep every tile of target, which holds the complete frame for view
+    void store(const FractalRenderer& fractal, const View& view, const RenderTarget& target);
+
+    size_t max_bytes(void) const { return m_max_bytes; }
+    void set_max_bytes(size_t max_bytes);
+
+    size_t tile_count(void) const { return m_index.size(); }
+    size_t bytes(void) const { return m_index.size() * TILE_BYTES; }
+
+    // lookups that composed a rect, and ones with a tile missing, since
+    // construction
+    uint64_t hits(void) const { return m_hits; }
+    uint64_t misses(void) const { return m_misses; }
+    uint64_t evictions(void) const { return m_evictions; }
+
+private:
+    // view's grid, as a key without the tile, and the grid pixel of the
+    // frame's bottom left pixel; false if view is not cached
+    bool grid_for(
+        const FractalRenderer& fractal, const View& view,
+        TileKey& key, int64_t& gx, int64_t& gy) const;
+
+    struct Entry
+    {
+        TileKey key;
+        Texture texture;
+        // the part of the tile that holds counts, where frames only covered
+        // some of it
+        Tile valid;
+    };
+
+    // cached tile, or nullptr
+    Entry* find(const TileKey& key);
+    void evict(void);
+
+private:
+
+    // most recently used first
+    std::list<Entry> m_lru;
+    std::unordered_map<TileKey, std::list<Entry>::iterator, TileKeyHash> m_index;
+    size_t m_max_bytes = 0;
+
+    uint64_t m_hits = 0, m_misses = 0, m_evictions = 0;
+
+    // a rect's tiles, composed in one draw
+    QuadBatch m_batch;
+};
+
+#endif // TILECACHEH
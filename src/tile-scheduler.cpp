@@ -0,0 +1,205 @@
+#include "tile-scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+
+namespace {
+using clock_type = std::chrono::steady_clock;
+
+static inline double ms_between(clock_type::time_point a, clock_type::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+}
+
+
+TileScheduler::TileScheduler(unsigned threads)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+
+    m_stats.resize(threads);
+    for (unsigned i = 0; i < threads; i++)
+        m_workers.emplace_back(std::make_unique<Worker>());
+    // start threads only once every deque exists, since workers steal
+    for (unsigned i = 0; i < threads; i++)
+        m_workers[i]->thread = std::thread(&TileScheduler::worker_main, this, i);
+}
+
+TileScheduler::~TileScheduler(void)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_start_cv.notify_all();
+
+    for (auto& worker : m_workers)
+        worker->thread.join();
+}
+
+
+void TileScheduler::run(
+    int width, int height, int tile_size,
+    const std::function<void(const Tile&)>& fn)
+{
+    if (width <= 0 || height <= 0 || tile_size <= 0) return;
+
+    const auto start = clock_type::now();
+
+    // cut the frame into tiles, row-major
+    std::vector<Tile> tiles;
+    for (int y = 0; y < height; y += tile_size)
+        for (int x = 0; x < width; x += tile_size)
+            tiles.push_back(Tile{
+                x, y,
+                std::min(tile_size, width - x),
+                std::min(tile_size, height - y)});
+
+    // deal contiguous blocks of tiles to each worker
+    const std::size_t nworkers = m_workers.size();
+    for (std::size_t w = 0; w < nworkers; w++)
+    {
+        const std::size_t first = w * tiles.size() / nworkers;
+        const std::size_t last = (w + 1) * tiles.size() / nworkers;
+
+        std::lock_guard lock(m_workers[w]->mutex);
+        m_workers[w]->tiles.assign(tiles.begin() + first, tiles.begin() + last);
+        m_stats[w] = WorkerStats{};
+    }
+
+    // wake workers and wait for all of them to run out of tiles
+    {
+        std::unique_lock lock(m_mutex);
+        mp_job = &fn;
+        m_finished = 0;
+        m_generation++;
+        m_start_cv.notify_all();
+        m_done_cv.wait(lock, [&]{ return m_finished == nworkers; });
+        mp_job = nullptr;
+    }
+
+    m_wall_ms = ms_between(start, clock_type::now());
+    for (auto& stats : m_stats)
+        stats.idle_ms = m_wall_ms - stats.busy_ms;
+}
+
+
+void TileScheduler::worker_main(unsigned idx)
+{
+    uint64_t seen_generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_start_cv.wait(lock, [&]{ return m_stop || m_generation != seen_generation; });
+            if (m_stop) return;
+            seen_generation = m_generation;
+        }
+
+        run_tiles(idx);
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_finished++;
+        }
+        m_done_cv.notify_one();
+    }
+}
+
+void TileScheduler::run_tiles(unsigned idx)
+{
+    WorkerStats& stats = m_stats[idx];
+
+    // no tiles are added mid-run, so once every deque (ours included) comes
+    // up empty there is nothing left for this worker to do
+    Tile tile;
+    while (true)
+    {
+        if (!pop_local(idx, tile))
+        {
+            if (!steal(idx, tile))
+                break;
+            stats.steals++;
+        }
+
+        const auto start = clock_type::now();
+        (*mp_job)(tile);
+        stats.busy_ms += ms_between(start, clock_type::now());
+        stats.tiles++;
+    }
+}
+
+bool TileScheduler::pop_local(unsigned idx, Tile& tile)
+{
+    Worker& self = *m_workers[idx];
+    std::lock_guard lock(self.mutex);
+    if (self.tiles.empty()) return false;
+    tile = self.tiles.back();
+    self.tiles.pop_back();
+    return true;
+}
+
+bool TileScheduler::steal(unsigned idx, Tile& tile)
+{
+    // sweep victims starting from our neighbour, so thieves spread out
+    const std::size_t nworkers = m_workers.size();
+    for (std::size_t k = 1; k < nworkers; k++)
+    {
+        Worker& victim = *m_workers[(idx + k) % nworkers];
+        std::lock_guard lock(victim.mutex);
+        if (victim.tiles.empty()) continue;
+        tile = victim.tiles.front();
+        victim.tiles.pop_front();
+        return true;
+    }
+    return false;
+}
+
+
+void TileScheduler::print_stats(std::ostream& os) const
+{
+    double busy_total = 0.0;
+    for (std::size_t i = 0; i < m_stats.size(); i++)
+    {
+        const WorkerStats& s = m_stats[i];
+        busy_total += s.busy_ms;
+        os << "worker " << std::setw(3) << i
+            << std::fixed << std::setprecision(2)
+            << " busy " << std::setw(9) << s.busy_ms << "ms"
+            << " idle " << std::setw(9) << s.idle_ms << "ms"
+            << " tiles " << std::setw(6) << s.tiles
+            << " stolen " << std::setw(6) << s.steals
+            << '\n';
+    }
+
+    // fraction of the available thread-time spent doing useful work
+    const double available = m_wall_ms * m_stats.size();
+    os << "wall " << std::fixed << std::setprecision(2) << m_wall_ms << "ms"
+        << " utilization " << std::setprecision(1)
+        << (available > 0.0? 100.0 * busy_total / available : 0.0) << "%"
+        << std::endl;
+}
+
+
+void render_tiled(
+    TileScheduler& scheduler,
+    const EscapeTime& engine,
+    const FractalParams& params,
+    int width, int height,
+    uint32_t* out,
+    int tile_size)
+{
+    scheduler.run(width, height, tile_size,
+        [&](const Tile& tile)
+        {
+            engine.render_rect(
+                params, width, height,
+                tile.x, tile.y, tile.width, tile.height,
+                out + (std::size_t)tile.y * width + tile.x, width);
+        });
+}
@@ -0,0 +1,102 @@
+#ifndef TILESCHEDULERH
+#define TILESCHEDULERH
+
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include "escape-time.hpp"
+
+
+struct Tile
+{
+    int x = 0, y = 0;
+    int width = 0, height = 0;
+};
+
+struct WorkerStats
+{
+    double busy_ms = 0.0; // time spent running tiles
+    double idle_ms = 0.0; // time spent stealing or waiting for the frame to end
+    uint64_t tiles = 0;   // tiles run, including stolen ones
+    uint64_t steals = 0;  // tiles taken from another worker's deque
+};
+
+
+// splits a frame into tiles and runs them on a pool of worker threads
+//
+// tiles are dealt out to per-worker deques in contiguous blocks, so that
+// neighbouring (similarly expensive) tiles start on the same worker; workers
+// pop their own deque from the back and steal from the front of others' once
+// theirs runs dry
+class TileScheduler
+{
+public:
+    // threads == 0 uses one worker per hardware thread
+    explicit TileScheduler(unsigned threads = 0);
+    ~TileScheduler(void);
+
+    TileScheduler(const TileScheduler&) = delete;
+    TileScheduler& operator=(const TileScheduler&) = delete;
+
+public:
+    unsigned thread_count(void) const { return (unsigned)m_workers.size(); }
+
+    // run fn over every tile_size*tile_size tile of a width*height frame,
+    // blocking until all tiles are done; fn is called concurrently
+    void run(
+        int width, int height, int tile_size,
+        const std::function<void(const Tile&)>& fn);
+
+    // per-worker stats and wall time of the last run()
+    const std::vector<WorkerStats>& last_stats(void) const { return m_stats; }
+    double last_wall_ms(void) const { return m_wall_ms; }
+
+    // utilization summary of the last run(), one line per worker
+    void print_stats(std::ostream& os) const;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Tile> tiles;
+        std::thread thread;
+    };
+
+    void worker_main(unsigned idx);
+    void run_tiles(unsigned idx);
+    bool pop_local(unsigned idx, Tile& tile);
+    bool steal(unsigned idx, Tile& tile);
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<WorkerStats> m_stats;
+    double m_wall_ms = 0.0;
+
+    // current job, valid while a run() is in progress
+    const std::function<void(const Tile&)>* mp_job = nullptr;
+
+    std::mutex m_mutex;
+    std::condition_variable m_start_cv, m_done_cv;
+    uint64_t m_generation = 0;
+    unsigned m_finished = 0;
+    bool m_stop = false;
+};
+
+
+// iterate a whole frame on every worker, see EscapeTime::render()
+void render_tiled(
+    TileScheduler& scheduler,
+    const EscapeTime& engine,
+    const FractalParams& params,
+    int width, int height,
+    uint32_t* out,
+    int tile_size = 64);
+
+#endif // TILESCHEDULERH
@@ -0,0 +1,61 @@
+#ifndef TRIPLEBUFFERH
+#define TRIPLEBUFFERH
+
+#include <stdint.h>
+#include <atomic>
+
+
+// hands the latest value from one writer thread to one reader thread,
+// without locks and without either side ever waiting on the other
+//
+// the writer fills a back slot and swaps it with the middle one; the reader
+// swaps the middle one with its front slot when a newer value is there.
+// values written in between two reads are skipped, only the latest counts
+//
+//     writer:                      reader:
+//     buffer.write(value);         if (buffer.update())
+//                                      use(buffer.read());
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer(void) = default;
+    // every slot starts as value, so read() is valid before the first write
+    explicit TripleBuffer(const T& value) : m_slots{value, value, value} {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+public:
+    // writer only: make value the latest
+    void write(const T& value)
+    {
+        m_slots[m_back] = value;
+        m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // reader only: take the latest value, if one was written since the last
+    // update(); false (and read() unchanged) if not
+    bool update(void)
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    // reader only: the value taken by the last update()
+    const T& read(void) const { return m_slots[m_front]; }
+
+private:
+    // m_middle is a slot index, with FRESH set while the reader has not
+    // taken it
+    constexpr static uint8_t INDEX = 0x3;
+    constexpr static uint8_t FRESH = 0x4;
+
+    T m_slots[3];
+    uint8_t m_front = 0; // reader's
+    uint8_t m_back = 2;  // writer's
+    std::atomic<uint8_t> m_middle = 1;
+};
+
+#endif // TRIPLEBUFFERH
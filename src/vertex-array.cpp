@@ -3,6 +3,8 @@
 #include <iostream>
 #include <utility>
 
+#include "gl-state.hpp"
+
 
 static inline GLuint generate_vertex_buffer_id(void)
 {
@@ -139,7 +141,7 @@ void VertexBuffer::add_attrib(GLint count, GLenum type)
 
     // advance
     m_working_attrib_idx++;
-    m_working_offset += size;
+    m_working_offset += size * count;
 }
 
 void VertexBuffer::bind_data(void* data, GLsizei count, GLenum usage)
@@ -148,6 +150,12 @@ void VertexBuffer::bind_data(void* data, GLsizei count, GLenum usage)
     glBufferData(GL_ARRAY_BUFFER, count*m_stride, data, usage);
 }
 
+void VertexBuffer::update_data(const void* data, GLsizei count)
+{
+    use();
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count*m_stride, data);
+}
+
 
 VertexArray::VertexArray(void) :
     m_vao(generate_vertex_array_id())
@@ -158,6 +166,7 @@ VertexArray::~VertexArray(void)
     // vbos should be deleted before vao
     m_buffers.clear();
 
+    GLState::current().forget_vertex_array(m_vao);
     glDeleteVertexArrays(1, &m_vao);
 }
 
@@ -188,4 +197,4 @@ const VertexBuffer& VertexArray::get_buffer(std::size_t i) const
 { return m_buffers.at(i); }
 
 void VertexArray::use(void) const
-{ glBindVertexArray(m_vao); }
+{ GLState::current().bind_vertex_array(m_vao); }
@@ -30,6 +30,9 @@ public:
     void add_attrib(GLint count, GLenum type);
 
     void bind_data(void* data, GLsizei count, GLenum usage);
+    // overwrite the first count elements, without reallocating; bind_data()
+    // must have made room for them
+    void update_data(const void* data, GLsizei count);
 
 private:
     GLsizei m_stride = 0;
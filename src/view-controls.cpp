@@ -0,0 +1,86 @@
+#include "view-controls.hpp"
+
+#include <cmath>
+
+
+namespace {
+
+// keys that keep changing the view for as long as they are held
+constexpr SDL_Scancode VIEW_KEYS[] =
+{
+    SDL_SCANCODE_W, SDL_SCANCODE_A, SDL_SCANCODE_S, SDL_SCANCODE_D,
+    SDL_SCANCODE_Q, SDL_SCANCODE_E,
+    SDL_SCANCODE_LEFTBRACKET, SDL_SCANCODE_RIGHTBRACKET,
+    SDL_SCANCODE_MINUS, SDL_SCANCODE_EQUALS,
+    SDL_SCANCODE_R,
+};
+
+// -1, 0 or +1 from a pair of opposite keys
+int axis(const Uint8* keyboard, SDL_Scancode minus, SDL_Scancode plus)
+{
+    return (keyboard[plus]? 1 : 0) - (keyboard[minus]? 1 : 0);
+}
+
+// take the whole pixels out of pan, leaving the fraction
+int whole_pixels(double& pan)
+{
+    const int whole = (int)std::trunc(pan);
+    pan -= whole;
+    return whole;
+}
+
+} // namespace
+
+
+bool ViewControls::is_view_key(SDL_Scancode key)
+{
+    for (SDL_Scancode view_key : VIEW_KEYS)
+        if (key == view_key) return true;
+    return false;
+}
+
+bool ViewControls::held(const Uint8* keyboard)
+{
+    for (SDL_Scancode key : VIEW_KEYS)
+        if (keyboard[key]) return true;
+    return false;
+}
+
+
+bool ViewControls::update(const Uint8* keyboard, double seconds, int internal_height, View& view)
+{
+    if (keyboard[SDL_SCANCODE_R])  // reset view
+    {
+        view.centerx = BigFixed(0.0);
+        view.centery = BigFixed(0.0);
+        view.zoom = 0.4;
+        m_pan_x = m_pan_y = 0.0;
+        return true;
+    }
+
+    const double step = (keyboard[SDL_SCANCODE_LSHIFT]? FAST : 1.0) * seconds;
+    const int pan_x = axis(keyboard, SDL_SCANCODE_A, SDL_SCANCODE_D);  // real
+    const int pan_y = axis(keyboard, SDL_SCANCODE_S, SDL_SCANCODE_W);  // imag
+    const int zoom = axis(keyboard, SDL_SCANCODE_Q, SDL_SCANCODE_E);
+    const int exponent = axis(keyboard, SDL_SCANCODE_LEFTBRACKET, SDL_SCANCODE_RIGHTBRACKET);
+    const int threshhold = axis(keyboard, SDL_SCANCODE_MINUS, SDL_SCANCODE_EQUALS);
+
+    // a released key does not leave part of a pixel behind for the next press
+    if (pan_x == 0) m_pan_x = 0.0;
+    if (pan_y == 0) m_pan_y = 0.0;
+    m_pan_x += pan_x * PAN_SPEED * internal_height * step;
+    m_pan_y += pan_y * PAN_SPEED * internal_height * step;
+
+    // pan first, at the zoom the pixels were counted at
+    const double pixel = 2.0 / (view.zoom * internal_height);
+    const int dx = whole_pixels(m_pan_x);
+    const int dy = whole_pixels(m_pan_y);
+    if (dx != 0) view.centerx += dx * pixel;
+    if (dy != 0) view.centery += dy * pixel;
+
+    if (zoom != 0) view.zoom *= std::exp(zoom * ZOOM_SPEED * step);
+    if (exponent != 0) view.exponent += exponent * EXPONENT_SPEED * step;
+    if (threshhold != 0) view.threshhold += threshhold * THRESHHOLD_SPEED * step;
+
+    return dx != 0 || dy != 0 || zoom != 0 || exponent != 0 || threshhold != 0;
+}
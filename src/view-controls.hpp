@@ -0,0 +1,42 @@
+#ifndef VIEWCONTROLSH
+#define VIEWCONTROLSH
+
+#include <stdint.h>
+
+#include <SDL2/SDL.h>
+
+#include "view.hpp"
+
+
+// moves a View for as long as keys are held, at speeds in real time rather
+// than per frame, so the controls feel the same at 10 frames a second as at
+// 144 (arbitrary sensitivities, left shift is FAST times as fast)
+//
+// pans go by whole pixels of the internal resolution, so the previous frame
+// can be reused exactly; what is left of a pixel carries over to the next
+// step for as long as the key is held
+class ViewControls
+{
+public:
+    constexpr static double PAN_SPEED = 1.5;        // view heights per second
+    constexpr static double ZOOM_SPEED = 3.0;       // e-folds per second
+    constexpr static double EXPONENT_SPEED = 0.3;   // per second
+    constexpr static double THRESHHOLD_SPEED = 3.0; // per second
+    constexpr static double FAST = 5.0;
+
+    // true for the keys that keep changing the view for as long as they
+    // are held
+    static bool is_view_key(SDL_Scancode key);
+    // true if any of them is held
+    static bool held(const Uint8* keyboard);
+
+    // apply seconds of what keyboard holds to view; pans are whole pixels
+    // of internal_height. true if view changed
+    bool update(const Uint8* keyboard, double seconds, int internal_height, View& view);
+
+private:
+    // pixels panned but not applied yet
+    double m_pan_x = 0.0, m_pan_y = 0.0;
+};
+
+#endif // VIEWCONTROLSH
@@ -0,0 +1,60 @@
+#ifndef VIEWH
+#define VIEWH
+
+#include <stdint.h>
+#include <string.h>
+
+#include "bigfixed.hpp"
+#include "escape-time.hpp"
+
+
+// exact comparison for change tracking, without tripping -Wfloat-equal
+inline bool bits_equal(double a, double b)
+{
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+
+// everything that decides what a frame of the fractal looks like
+struct View
+{
+    // center is kept in high precision so deep zooms can still pan
+    BigFixed centerx, centery;
+    double zoom = 0.4;
+
+    double exponent = 2.0;
+    double threshhold = 2.0;
+    uint32_t max_steps = 1024;
+
+    // size of the target being rendered, in pixels
+    int width = 1, height = 1;
+
+    double aspect(void) const { return (double)width / height; }
+
+    // true if both views render the exact same frame
+    bool operator==(const View& rhs) const
+    {
+        return centerx == rhs.centerx && centery == rhs.centery
+            && bits_equal(zoom, rhs.zoom)
+            && bits_equal(exponent, rhs.exponent)
+            && bits_equal(threshhold, rhs.threshhold)
+            && max_steps == rhs.max_steps
+            && width == rhs.width && height == rhs.height;
+    }
+
+    // double precision parameters, for the float shader and cpu engine
+    FractalParams params(void) const
+    {
+        FractalParams p;
+        p.centerx = centerx.to_double();
+        p.centery = centery.to_double();
+        p.zoom = zoom;
+        p.aspect = aspect();
+        p.exponent = exponent;
+        p.threshhold = threshhold;
+        p.max_steps = max_steps;
+        return p;
+    }
+};
+
+#endif // VIEWH
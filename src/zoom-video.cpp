@@ -0,0 +1,186 @@
+#include "zoom-video.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string.h>
+
+#include "gl-state.hpp"
+
+
+namespace {
+
+static const float s_quad_vertices[] =
+{
+    // position
+    -1.0f,  1.0f,
+    -1.0f, -1.0f,
+     1.0f, -1.0f,
+
+    -1.0f,  1.0f,
+     1.0f, -1.0f,
+     1.0f,  1.0f
+};
+
+constexpr static double TAU = 6.283185307179586;
+
+// pattern with its run of '#' replaced by frame, zero-padded to the run's
+// length
+static std::string frame_path(const std::string& pattern, int frame)
+{
+    const std::size_t first = pattern.find('#');
+    const std::size_t last = pattern.find_first_not_of('#', first);
+    const std::size_t width = ((last == std::string::npos)? pattern.size() : last) - first;
+
+    std::string number = std::to_string(frame);
+    if (number.size() < width)
+        number.insert(0, width - number.size(), '0');
+    return pattern.substr(0, first) + number + pattern.substr(first + width);
+}
+
+// binary ppm, rows flipped from GL's bottom-up order
+static bool write_ppm(const std::string& path, int width, int height, const std::vector<uint8_t>& rgb)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << "P6\n" << width << " " << height << "\n255\n";
+    const std::size_t row = (std::size_t)width * 3;
+    for (int y = height - 1; y >= 0; y--)
+        file.write((const char*)rgb.data() + y * row, row);
+
+    file.close();
+    if (!file)
+    {
+        std::cerr << "could not write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+
+ZoomVideo::ZoomVideo(FractalRenderer& fractal, Colorizer& colorizer) :
+    m_fractal(fractal),
+    m_colorizer(colorizer),
+    m_band(1, 1, GL_RG32F),
+    m_ring(1, 1),
+    m_frame(1, 1),
+    m_prog(
+        std::filesystem::path{"shaders/mandelbrot.vert"},
+        std::filesystem::path{"shaders/expmap.frag"})
+{
+    m_vao.add_vertex_buffer(2*sizeof(float), 0);
+    auto& vbo = m_vao.get_buffer(0);
+    vbo.add_attrib(2, GL_FLOAT); // vec2 v_position
+    vbo.bind_data((void*)s_quad_vertices, 6, GL_STATIC_DRAW);
+
+    m_unif_frame_size = m_prog.get_uniform("frame_size");
+    m_unif_row_base = m_prog.get_uniform("row_base");
+    m_unif_row_frac = m_prog.get_uniform("row_frac");
+
+    // exp_map sampler reads from slot 0
+    m_prog.use();
+    glUniform1i(m_prog.get_uniform("exp_map"), 0);
+}
+
+
+void ZoomVideo::render_band(const View& end, int64_t first_row)
+{
+    m_band.use();
+    m_fractal.draw_exp_map(end,
+        m_outer * std::exp(-(double)first_row * m_per_texel),
+        BAND_HEIGHT * m_per_texel);
+
+    // the ring is a whole number of bands, so a band never wraps
+    m_ring.use();
+    GLState::current().viewport(0, (int)(first_row % m_ring.height()), m_map_width, BAND_HEIGHT);
+    m_colorizer.draw(m_band.color_texture());
+}
+
+bool ZoomVideo::run(const View& end, double start_zoom, int frames, bool smooth, const std::string& pattern)
+{
+    if (pattern.find('#') == std::string::npos)
+    {
+        std::cerr << "zoom video output needs a run of '#' for the frame number: "
+            << pattern << std::endl;
+        return false;
+    }
+    if (integer_exponent(end.exponent) != 2)
+    {
+        std::cerr << "zoom videos are drawn by perturbation, exponent 2 only" << std::endl;
+        return false;
+    }
+
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+
+    // one texel per pixel at the frame's corners, the farthest any pixel
+    // gets from the center; rows are as tall in log radius as columns are
+    // wide in angle
+    const double half_diagonal = 0.5 * std::hypot(end.width, end.height);
+    m_map_width = std::min((int)std::ceil(TAU * half_diagonal), (int)max_size);
+    m_per_texel = TAU / m_map_width;
+
+    // map row r is at radius m_outer * e^(-(r + 0.5) * m_per_texel), and
+    // starts a row past the first frame's corners
+    const auto pixel_size = [&](double zoom) { return 2.0 / (zoom * end.height); };
+    m_outer = half_diagonal * pixel_size(start_zoom) * std::exp(m_per_texel);
+
+    // a frame needs the rows from its corners in to half a pixel from its
+    // center, plus a band being drawn
+    const double frame_rows = std::log(half_diagonal / 0.5) / m_per_texel;
+    const int ring_rows = ((int)std::ceil(frame_rows) + 3 + 2 * BAND_HEIGHT - 1)
+        / BAND_HEIGHT * BAND_HEIGHT;
+    if (ring_rows > max_size)
+    {
+        std::cerr << "frames of " << end.width << "x" << end.height
+            << " need a " << m_map_width << "x" << ring_rows
+            << " map, past this gpu's texture size" << std::endl;
+        return false;
+    }
+
+    m_band.resize(m_map_width, BAND_HEIGHT);
+    m_ring.resize(m_map_width, ring_rows);
+    m_frame.resize(end.width, end.height);
+    m_colorizer.set_smooth(smooth);
+    m_rows_done = 0;
+
+    for (int k = 0; k < frames; k++)
+    {
+        // constant zoom rate, so each frame takes the same number of rows
+        const double t = (frames > 1)? (double)k / (frames - 1) : 1.0;
+        const double zoom = start_zoom * std::pow(end.zoom / start_zoom, t);
+
+        // map row (fractional) under a point 1 pixel from the center
+        const double row = std::log(m_outer / pixel_size(zoom)) / m_per_texel - 0.5;
+        const int64_t row_base = (int64_t)std::floor(row);
+        const int64_t last_row = (int64_t)std::floor(row - std::log(0.5) / m_per_texel) + 1;
+
+        while (m_rows_done <= last_row)
+        {
+            render_band(end, m_rows_done);
+            m_rows_done += BAND_HEIGHT;
+        }
+
+        m_frame.use();
+        m_prog.use();
+        glUniform2f(m_unif_frame_size, end.width, end.height);
+        glUniform1i(m_unif_row_base, (GLint)(row_base % ring_rows));
+        glUniform1f(m_unif_row_frac, (float)(row - row_base));
+        GLState::current().active_texture(0);
+        m_ring.color_texture().use();
+        m_vao.use();
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+
+        m_frame.read_rgb(m_rgb);
+        const std::string path = frame_path(pattern, k);
+        if (!write_ppm(path, end.width, end.height, m_rgb))
+            return false;
+
+        std::cout << "\r" << pattern << ": " << k + 1 << "/" << frames
+            << " frames" << std::flush;
+    }
+    std::cout << std::endl;
+    return true;
+}
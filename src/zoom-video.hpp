@@ -0,0 +1,69 @@
+#ifndef ZOOMVIDEOH
+#define ZOOMVIDEOH
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include "colorizer.hpp"
+#include "fractal-renderer.hpp"
+#include "program.hpp"
+#include "rendertarget.hpp"
+#include "vertex-array.hpp"
+#include "view.hpp"
+
+
+// renders the frames of a zoom into a view's center as ppm files, without
+// iterating each frame: the whole path is drawn once as an exponential map
+// (angle around the center by log radius, see expmap.frag), and every frame
+// is resampled from it. the map grows with how deep the zoom goes, not with
+// the frame count
+//
+// map rows are drawn in bands as the zoom needs them, into a ring holding
+// just enough rows for one frame, so memory does not grow with depth either
+class ZoomVideo
+{
+public:
+    constexpr static int BAND_HEIGHT = 64;
+
+    ZoomVideo(FractalRenderer& fractal, Colorizer& colorizer);
+
+public:
+    // frames zoom from start_zoom to end.zoom at a constant rate; each is
+    // written to pattern with its run of '#' replaced by the zero-padded
+    // frame number. false (after printing why) if a frame failed
+    bool run(const View& end, double start_zoom, int frames, bool smooth, const std::string& pattern);
+
+    // size of the last run's whole map, in texels
+    int map_width(void) const { return m_map_width; }
+    int64_t map_rows(void) const { return m_rows_done; }
+
+private:
+    // draw and color map rows [first_row, first_row + BAND_HEIGHT) into
+    // the ring
+    void render_band(const View& end, int64_t first_row);
+
+private:
+    FractalRenderer& m_fractal;
+    Colorizer& m_colorizer;
+
+    RenderTarget m_band;  // iteration counts of one band
+    RenderTarget m_ring;  // colored rows, row r at r % height
+    RenderTarget m_frame;
+    std::vector<uint8_t> m_rgb;
+
+    VertexArray m_vao;
+    Program m_prog;
+    GLint m_unif_frame_size = -1;
+    GLint m_unif_row_base = -1, m_unif_row_frac = -1;
+
+    int m_map_width = 0;
+    // radius of map row 0's outer edge, and the log radius per texel
+    double m_outer = 0.0, m_per_texel = 0.0;
+    int64_t m_rows_done = 0;
+};
+
+#endif // ZOOMVIDEOH